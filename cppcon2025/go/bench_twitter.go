@@ -0,0 +1,116 @@
+package main
+
+// The Go side of the cross-language harness (../harness/run.py): the fields
+// of software/twitter_data.h, parsed and serialized with encoding/json.
+//
+// Usage: go run bench_twitter.go twitter.json [warmup] [iterations]
+
+import (
+	"bytes"
+	"encoding/json"
+	"fmt"
+	"os"
+	"strconv"
+	"time"
+)
+
+type User struct {
+	ID             int64  `json:"id"`
+	ScreenName     string `json:"screen_name"`
+	Name           string `json:"name"`
+	FollowersCount int64  `json:"followers_count"`
+	FriendsCount   int64  `json:"friends_count"`
+}
+
+type Status struct {
+	CreatedAt       string `json:"created_at"`
+	ID              int64  `json:"id"`
+	IDStr           string `json:"id_str"`
+	Text            string `json:"text"`
+	Source          string `json:"source"`
+	Truncated       bool   `json:"truncated"`
+	InReplyToUserID *int64 `json:"in_reply_to_user_id"`
+	User            User   `json:"user"`
+	RetweetCount    int64  `json:"retweet_count"`
+	FavoriteCount   int64  `json:"favorite_count"`
+	Favorited       bool   `json:"favorited"`
+	Retweeted       bool   `json:"retweeted"`
+	Lang            string `json:"lang"`
+}
+
+type TwitterFeed struct {
+	Statuses []Status `json:"statuses"`
+}
+
+// Like the other languages: no HTML escaping, no trailing newline.
+func serialize(feed *TwitterFeed, out *bytes.Buffer) {
+	out.Reset()
+	encoder := json.NewEncoder(out)
+	encoder.SetEscapeHTML(false)
+	if err := encoder.Encode(feed); err != nil {
+		fmt.Fprintln(os.Stderr, "Error serializing JSON:", err)
+		os.Exit(1)
+	}
+	out.Truncate(out.Len() - 1)
+}
+
+func parse(input []byte, feed *TwitterFeed) {
+	*feed = TwitterFeed{}
+	if err := json.Unmarshal(input, feed); err != nil {
+		fmt.Fprintln(os.Stderr, "Error parsing JSON:", err)
+		os.Exit(1)
+	}
+}
+
+// The schema shared by all languages.
+func report(workload string, inputBytes, outputBytes, items, iterations int, seconds float64, volume int) {
+	fmt.Printf("{\"language\":\"Go\",\"library\":\"encoding/json\",\"workload\":\"%s\","+
+		"\"input_bytes\":%d,\"output_bytes\":%d,\"items\":%d,\"iterations\":%d,\"seconds\":%.6f,"+
+		"\"mb_per_s\":%.2f}\n",
+		workload, inputBytes, outputBytes, items, iterations, seconds,
+		float64(volume)*float64(iterations)/seconds/1e6)
+}
+
+func main() {
+	if len(os.Args) < 2 {
+		fmt.Fprintln(os.Stderr, "Usage: bench_twitter twitter.json [warmup] [iterations]")
+		os.Exit(1)
+	}
+	warmup, iterations := 100, 1000
+	if len(os.Args) > 2 {
+		warmup, _ = strconv.Atoi(os.Args[2])
+	}
+	if len(os.Args) > 3 {
+		iterations, _ = strconv.Atoi(os.Args[3])
+	}
+	input, err := os.ReadFile(os.Args[1])
+	if err != nil {
+		fmt.Fprintln(os.Stderr, "Error reading file:", err)
+		os.Exit(1)
+	}
+	var feed TwitterFeed
+	var out bytes.Buffer
+	parse(input, &feed)
+	serialize(&feed, &out)
+	outputBytes := out.Len()
+
+	for i := 0; i < warmup; i++ {
+		parse(input, &feed)
+	}
+	start := time.Now()
+	for i := 0; i < iterations; i++ {
+		parse(input, &feed)
+	}
+	seconds := time.Since(start).Seconds()
+	report("parse", len(input), outputBytes, len(feed.Statuses), iterations, seconds, len(input))
+
+	for i := 0; i < warmup; i++ {
+		serialize(&feed, &out)
+	}
+	start = time.Now()
+	for i := 0; i < iterations; i++ {
+		serialize(&feed, &out)
+	}
+	seconds = time.Since(start).Seconds()
+	report("serialize", len(input), outputBytes, len(feed.Statuses), iterations, seconds, outputBytes)
+}
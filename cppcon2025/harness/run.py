@@ -0,0 +1,124 @@
+"""Cross-language twitter.json benchmark.
+
+Runs the same workload in every language: parse twitter.json into the
+fields of software/twitter_data.h (thirteen per status, five per user),
+then serialize them back, compactly.
+
+    C++   software/harness_bench.cpp   simdjson reflection
+    Go    go/bench_twitter.go          encoding/json
+    Java  java/TwitterBench.java       Jackson
+    Rust  rust/src/main.rs             serde_json
+
+Every program gets the same file, warmup and iteration count, and prints
+one JSON line per workload in the same schema. Since all extract the same
+fields, the serialized output must have the same size everywhere: a
+language whose output_bytes or items differ fails the volume check (and
+its numbers do not measure the same work).
+
+    python3 harness/run.py [--warmup 100] [--iterations 1000] [--output results.json]
+
+Languages whose toolchain is missing (or, for C++, without a
+software/build directory, see software/README.md) are skipped.
+"""
+import argparse
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BUILD = os.path.join(ROOT, 'harness', 'build')
+
+
+def build_cpp():
+    build = os.path.join(ROOT, 'software', 'build')
+    if not shutil.which('cmake') or not os.path.isdir(build):
+        return None
+    subprocess.run(['cmake', '--build', build, '--target', 'harness_bench'], check=True)
+    return [os.path.join(build, 'harness_bench')]
+
+
+def build_go():
+    if not shutil.which('go'):
+        return None
+    binary = os.path.join(BUILD, 'bench_twitter_go')
+    subprocess.run(['go', 'build', '-o', binary, 'bench_twitter.go'], cwd=os.path.join(ROOT, 'go'), check=True)
+    return [binary]
+
+
+def build_java():
+    if not shutil.which('mvn') or not shutil.which('java'):
+        return None
+    java = os.path.join(ROOT, 'java')
+    subprocess.run(['mvn', '-q', 'package'], cwd=java, check=True)
+    return ['java', '-jar', os.path.join(java, 'target', 'bench-twitter.jar')]
+
+
+def build_rust():
+    if not shutil.which('cargo'):
+        return None
+    rust = os.path.join(ROOT, 'rust')
+    subprocess.run(['cargo', 'build', '--release', '-q'], cwd=rust, check=True)
+    return [os.path.join(rust, 'target', 'release', 'bench_twitter')]
+
+
+LANGUAGES = [('C++', build_cpp), ('Go', build_go), ('Java', build_java), ('Rust', build_rust)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Cross-language twitter.json parse and serialize benchmark.')
+    parser.add_argument('--input', default=os.path.join(ROOT, 'go', 'twitter.json'))
+    parser.add_argument('--warmup', type=int, default=100)
+    parser.add_argument('--iterations', type=int, default=1000)
+    parser.add_argument('--output', default=os.path.join(BUILD, 'results.json'))
+    args = parser.parse_args()
+    os.makedirs(BUILD, exist_ok=True)
+
+    results = []
+    skipped = []
+    for language, build in LANGUAGES:
+        try:
+            command = build()
+        except subprocess.CalledProcessError as error:
+            print(f'{language}: build failed ({error})', file=sys.stderr)
+            command = None
+        if command is None:
+            skipped.append(language)
+            continue
+        run = subprocess.run(command + [args.input, str(args.warmup), str(args.iterations)],
+                             capture_output=True, text=True, check=True)
+        for line in run.stdout.splitlines():
+            result = json.loads(line)
+            print(f"{result['language']:<5} {result['workload']:<10} {result['mb_per_s']:>10.2f} MB/s")
+            results.append(result)
+
+    # The reference volume is the C++ one, or the first language that ran.
+    reference = results[0] if results else None
+    for result in results:
+        result['volume_check'] = ('ok' if (result['output_bytes'], result['items']) ==
+                                  (reference['output_bytes'], reference['items']) else 'mismatch')
+        if result['volume_check'] != 'ok':
+            print(f"{result['language']}: {result['output_bytes']} bytes and {result['items']} items, expected "
+                  f"{reference['output_bytes']} and {reference['items']}", file=sys.stderr)
+
+    document = {
+        'dataset': os.path.basename(args.input),
+        'input_bytes': os.path.getsize(args.input),
+        'warmup': args.warmup,
+        'iterations': args.iterations,
+        'host': platform.node(),
+        'processor': platform.processor() or platform.machine(),
+        'skipped': skipped,
+        'results': results,
+    }
+    with open(args.output, 'w') as f:
+        json.dump(document, f, indent=2)
+        f.write('\n')
+    print(f'wrote {args.output}')
+    return 0 if all(r['volume_check'] == 'ok' for r in results) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
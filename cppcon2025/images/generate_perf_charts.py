@@ -1,3 +1,6 @@
+import json
+import sys
+
 import matplotlib.pyplot as plt
 plt.rcParams.update({'font.size': 16})
 
@@ -101,4 +104,47 @@ plt.close()
 
 
 
+# Chart 3: Ablation study, from the ablation.json that the `ablation` CMake
+# target writes (python3 generate_perf_charts.py build/ablation.json).
+# Contribution of an optimization: (baseline - disabled) / disabled. The
+# simdjson_to_json rows are the real serializer on the same data, printed
+# next to the baseline to check that the study's writer is representative.
+if len(sys.argv) > 1:
+    with open(sys.argv[1]) as f:
+        ablation = json.load(f)
+    speeds = {(r['dataset'], r['variant']): r['mb_per_s'] for r in ablation['results']}
+    datasets = sorted({dataset for dataset, _ in speeds})
+    optimizations = [("no_consteval_keys", "Consteval"), ("no_simd_escape", "SIMD Escaping"),
+                     ("no_fast_digits", "Fast Digits")]
+    dataset_colors = ['#FFD700', '#6495ED']
+
+    plt.figure(figsize=(10, 6))
+    width = 0.8 / max(len(datasets), 1)
+    ax = plt.gca()
+    ax.spines['top'].set_visible(False)
+    ax.spines['right'].set_visible(False)
+    for d, dataset in enumerate(datasets):
+        baseline = speeds[(dataset, 'baseline')]
+        if (dataset, 'simdjson_to_json') in speeds:
+            print(f"{dataset}: baseline {baseline:.0f} MB/s, "
+                  f"simdjson::to_json {speeds[(dataset, 'simdjson_to_json')]:.0f} MB/s")
+        contributions = [100 * (baseline - speeds[(dataset, variant)]) / speeds[(dataset, variant)]
+                         for variant, _ in optimizations]
+        positions = [i + d * width for i in range(len(optimizations))]
+        bars = plt.bar(positions, contributions, width, label=dataset,
+                       color=dataset_colors[d % len(dataset_colors)], edgecolor='black')
+        for bar, contribution in zip(bars, contributions):
+            plt.text(bar.get_x() + bar.get_width()/2, bar.get_height() + 1, f'{contribution:+.0f}%',
+                     ha='center', va='bottom', fontsize=12)
+    plt.xticks([i + width * (len(datasets) - 1) / 2 for i in range(len(optimizations))],
+               [name for _, name in optimizations])
+    plt.ylabel('Contribution (%)', fontsize=14)
+    plt.title('Serialization Ablation Study', fontsize=16)
+    plt.text(0.01, 0.99, ablation['processor'], transform=ax.transAxes,
+             fontsize=14, ha='left', va='top', style='italic', color='black')
+    plt.legend(loc='upper right')
+    plt.tight_layout()
+    plt.savefig('ablation.png', dpi=300, bbox_inches='tight')
+    plt.close()
+
 print("Performance charts generated successfully!")
\ No newline at end of file
@@ -0,0 +1,81 @@
+import com.fasterxml.jackson.databind.DeserializationFeature;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.PropertyNamingStrategies;
+import com.fasterxml.jackson.databind.annotation.JsonNaming;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.List;
+
+// The Java side of the cross-language harness (../harness/run.py): the
+// fields of software/twitter_data.h, parsed and serialized with Jackson.
+//
+// Usage: mvn -q package && java -jar target/bench-twitter.jar twitter.json [warmup] [iterations]
+public class TwitterBench {
+    @JsonNaming(PropertyNamingStrategies.SnakeCaseStrategy.class)
+    public static class User {
+        public long id;
+        public String screenName;
+        public String name;
+        public long followersCount;
+        public long friendsCount;
+    }
+
+    @JsonNaming(PropertyNamingStrategies.SnakeCaseStrategy.class)
+    public static class Status {
+        public String createdAt;
+        public long id;
+        public String idStr;
+        public String text;
+        public String source;
+        public boolean truncated;
+        public Long inReplyToUserId;
+        public User user;
+        public long retweetCount;
+        public long favoriteCount;
+        public boolean favorited;
+        public boolean retweeted;
+        public String lang;
+    }
+
+    public static class TwitterFeed {
+        public List<Status> statuses;
+    }
+
+    // The schema shared by all languages.
+    static void report(String workload, int inputBytes, int outputBytes, int items, int iterations, double seconds,
+                       int volume) {
+        System.out.printf(java.util.Locale.ROOT,
+                "{\"language\":\"Java\",\"library\":\"Jackson\",\"workload\":\"%s\","
+                + "\"input_bytes\":%d,\"output_bytes\":%d,\"items\":%d,\"iterations\":%d,\"seconds\":%.6f,"
+                + "\"mb_per_s\":%.2f}%n",
+                workload, inputBytes, outputBytes, items, iterations, seconds,
+                (double) volume * iterations / seconds / 1e6);
+    }
+
+    public static void main(String[] args) throws Exception {
+        if (args.length < 1) {
+            System.err.println("Usage: TwitterBench twitter.json [warmup] [iterations]");
+            System.exit(1);
+        }
+        int warmup = args.length > 1 ? Integer.parseInt(args[1]) : 100;
+        int iterations = args.length > 2 ? Integer.parseInt(args[2]) : 1000;
+        byte[] input = Files.readAllBytes(Paths.get(args[0]));
+        // Like the other languages: the rest of each status is skipped.
+        ObjectMapper mapper = new ObjectMapper().configure(DeserializationFeature.FAIL_ON_UNKNOWN_PROPERTIES, false);
+        TwitterFeed feed = mapper.readValue(input, TwitterFeed.class);
+        byte[] out = mapper.writeValueAsBytes(feed);
+        int outputBytes = out.length;
+
+        for (int i = 0; i < warmup; i++) { feed = mapper.readValue(input, TwitterFeed.class); }
+        long start = System.nanoTime();
+        for (int i = 0; i < iterations; i++) { feed = mapper.readValue(input, TwitterFeed.class); }
+        double seconds = (System.nanoTime() - start) / 1e9;
+        report("parse", input.length, outputBytes, feed.statuses.size(), iterations, seconds, input.length);
+
+        for (int i = 0; i < warmup; i++) { out = mapper.writeValueAsBytes(feed); }
+        start = System.nanoTime();
+        for (int i = 0; i < iterations; i++) { out = mapper.writeValueAsBytes(feed); }
+        seconds = (System.nanoTime() - start) / 1e9;
+        report("serialize", input.length, outputBytes, feed.statuses.size(), iterations, seconds, outputBytes);
+    }
+}
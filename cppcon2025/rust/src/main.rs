@@ -0,0 +1,113 @@
+// The Rust side of the cross-language harness (../harness/run.py): the
+// fields of software/twitter_data.h, parsed and serialized with Serde.
+//
+// Usage: cargo run --release -- twitter.json [warmup] [iterations]
+use serde::{Deserialize, Serialize};
+use std::time::Instant;
+
+#[derive(Serialize, Deserialize, Default)]
+struct User {
+    id: i64,
+    screen_name: String,
+    name: String,
+    followers_count: i64,
+    friends_count: i64,
+}
+
+#[derive(Serialize, Deserialize, Default)]
+struct Status {
+    created_at: String,
+    id: i64,
+    id_str: String,
+    text: String,
+    source: String,
+    truncated: bool,
+    in_reply_to_user_id: Option<i64>,
+    user: User,
+    retweet_count: i64,
+    favorite_count: i64,
+    favorited: bool,
+    retweeted: bool,
+    lang: String,
+}
+
+#[derive(Serialize, Deserialize, Default)]
+struct TwitterFeed {
+    statuses: Vec<Status>,
+}
+
+// The schema shared by all languages.
+fn report(
+    workload: &str,
+    input_bytes: usize,
+    output_bytes: usize,
+    items: usize,
+    iterations: usize,
+    seconds: f64,
+    volume: usize,
+) {
+    println!("{{\"language\":\"Rust\",\"library\":\"serde_json\",\"workload\":\"{}\",\
+              \"input_bytes\":{},\"output_bytes\":{},\"items\":{},\"iterations\":{},\"seconds\":{:.6},\
+              \"mb_per_s\":{:.2}}}",
+             workload, input_bytes, output_bytes, items, iterations, seconds,
+             volume as f64 * iterations as f64 / seconds / 1e6);
+}
+
+fn main() {
+    let args: Vec<String> = std::env::args().collect();
+    if args.len() < 2 {
+        eprintln!("Usage: bench_twitter twitter.json [warmup] [iterations]");
+        std::process::exit(1);
+    }
+    let warmup: usize = args.get(2).map_or(100, |s| s.parse().expect("warmup"));
+    let iterations: usize = args.get(3).map_or(1000, |s| s.parse().expect("iterations"));
+    let input = std::fs::read(&args[1]).unwrap_or_else(|e| {
+        eprintln!("Error reading file: {}", e);
+        std::process::exit(1);
+    });
+    let parse = || -> TwitterFeed { serde_json::from_slice(&input).expect("Error parsing JSON") };
+    let mut out: Vec<u8> = Vec::new();
+    let serialize = |feed: &TwitterFeed, out: &mut Vec<u8>| {
+        out.clear();
+        serde_json::to_writer(&mut *out, feed).expect("Error serializing JSON");
+    };
+    let mut feed = parse();
+    serialize(&feed, &mut out);
+    let output_bytes = out.len();
+
+    for _ in 0..warmup {
+        feed = parse();
+    }
+    let start = Instant::now();
+    for _ in 0..iterations {
+        feed = parse();
+    }
+    let seconds = start.elapsed().as_secs_f64();
+    report(
+        "parse",
+        input.len(),
+        output_bytes,
+        feed.statuses.len(),
+        iterations,
+        seconds,
+        input.len(),
+    );
+
+    for _ in 0..warmup {
+        serialize(&feed, &mut out);
+    }
+    let start = Instant::now();
+    for _ in 0..iterations {
+        serialize(&feed, &mut out);
+    }
+    let seconds = start.elapsed().as_secs_f64();
+    report(
+        "serialize",
+        input.len(),
+        output_bytes,
+        feed.statuses.len(),
+        iterations,
+        seconds,
+        output_bytes,
+    );
+}
@@ -0,0 +1,270 @@
+// The serialization ablation study of the slides, as a program: a reflected
+// writer whose three optimizations can each be compiled out.
+//  - ABLATION_CONSTEVAL_KEYS: ,"name": is built at compile time and
+//    appended in one go; without it, names are quoted and escaped per call;
+//  - ABLATION_SIMD_ESCAPE: strings go through json_escape::escape_to();
+//    without it, through the byte-at-a-time escape_scalar_to();
+//  - ABLATION_FAST_DIGITS: integers are written backwards, to_chars-style,
+//    into as many bytes as they have digits, counted from the bit width;
+//    without it, the count is std::to_string(value).length(), the naive
+//    approach of the slides.
+// The ablation target builds one binary per disabled optimization (plus
+// the baseline), runs them all and writes ablation.json for
+// images/generate_perf_charts.py. Output is one JSON line per result; the
+// baseline also times simdjson::to_json() on the same value (variant
+// "simdjson_to_json"), so that this writer can be checked against the real
+// one.
+//
+// Usage: ./ablation_baseline twitter|citm file.json [rounds]
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <meta>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "citm_data.h"
+#include "json_escape.h"
+#include "mapped_file.h"
+#include "twitter_data.h"
+
+#ifndef ABLATION_CONSTEVAL_KEYS
+#define ABLATION_CONSTEVAL_KEYS 1
+#endif
+#ifndef ABLATION_SIMD_ESCAPE
+#define ABLATION_SIMD_ESCAPE 1
+#endif
+#ifndef ABLATION_FAST_DIGITS
+#define ABLATION_FAST_DIGITS 1
+#endif
+#ifndef ABLATION_VARIANT
+#define ABLATION_VARIANT "baseline"
+#endif
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template <typename T>
+struct is_map : std::false_type {};
+template <typename V, typename C, typename A>
+struct is_map<std::map<std::string, V, C, A>> : std::true_type {};
+
+template <typename T>
+inline constexpr auto members = std::define_static_array(
+    std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()));
+
+// ,"name": (the comma is skipped for the first member).
+template <std::meta::info Member>
+consteval auto make_key() {
+  constexpr std::string_view name = std::meta::identifier_of(Member);
+  std::array<char, name.size() + 4> key{};
+  key[0] = ',';
+  key[1] = '"';
+  for (size_t i = 0; i < name.size(); i++) { key[i + 2] = name[i]; }
+  key[name.size() + 2] = '"';
+  key[name.size() + 3] = ':';
+  return key;
+}
+
+template <std::meta::info Member>
+inline constexpr auto key = make_key<Member>();
+
+void write_escaped(std::string &out, std::string_view s) {
+  if constexpr (ABLATION_SIMD_ESCAPE) {
+    json_escape::escape_to(out, s);
+  } else {
+    json_escape::escape_scalar_to(out, s);
+  }
+}
+
+void write_string(std::string &out, std::string_view s) {
+  out += '"';
+  write_escaped(out, s);
+  out += '"';
+}
+
+// Decimal digits of v: about log10 from the bit width (1233 / 4096 is
+// close to log10(2)), plus one if v reaches the next power of ten. Zero
+// counts as one digit.
+inline size_t fast_digit_count(uint64_t v) {
+  static constexpr uint64_t powers[20] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+      10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+      10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+      1000000000000000000ULL, 10000000000000000000ULL};
+  const size_t digits = size_t(std::bit_width(v | 1) * 1233) >> 12;
+  return digits + ((v | 1) >= powers[digits] ? 1 : 0);
+}
+
+template <typename I>
+void write_integer(std::string &out, I value) {
+  using U = std::make_unsigned_t<I>;
+  const bool negative = value < 0;
+  U magnitude = negative ? U(U(0) - U(value)) : U(value);
+  size_t length;
+  if constexpr (ABLATION_FAST_DIGITS) {
+    length = (negative ? 1 : 0) + fast_digit_count(magnitude);
+  } else {
+    length = std::to_string(value).length();
+  }
+  const size_t start = out.size();
+  out.resize(start + length);
+  char *p = out.data() + start + length;
+  do {
+    *--p = char('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+  if (negative) { *--p = '-'; }
+}
+
+template <typename T>
+void write(std::string &out, const T &value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    out.append(value ? "true" : "false");
+  } else if constexpr (std::is_integral_v<T>) {
+    write_integer(out, value);
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    write_string(out, value);
+  } else if constexpr (is_optional<T>::value) {
+    if (value) {
+      write(out, *value);
+    } else {
+      out.append("null");
+    }
+  } else if constexpr (is_vector<T>::value) {
+    out += '[';
+    for (size_t i = 0; i < value.size(); i++) {
+      if (i > 0) { out += ','; }
+      write(out, value[i]);
+    }
+    out += ']';
+  } else if constexpr (is_map<T>::value) {
+    out += '{';
+    bool first = true;
+    for (const auto &[name, element] : value) {
+      if (!first) { out += ','; }
+      first = false;
+      write_string(out, name);
+      out += ':';
+      write(out, element);
+    }
+    out += '}';
+  } else {
+    static_assert(std::is_aggregate_v<T>, "ablation_bench writes the types of twitter_data.h and citm_data.h");
+    out += '{';
+    template for (constexpr auto member : members<T>) {
+      constexpr bool first = member == members<T>[0];
+      if constexpr (ABLATION_CONSTEVAL_KEYS) {
+        out.append(key<member>.data() + (first ? 1 : 0), key<member>.size() - (first ? 1 : 0));
+      } else {
+        if (!first) { out += ','; }
+        write_string(out, std::meta::identifier_of(member));
+        out += ':';
+      }
+      write(out, value.[:member:]);
+    }
+    out += '}';
+  }
+}
+
+// Best time out of rounds, in seconds.
+template <typename F>
+double best_seconds(size_t rounds, F f) {
+  double best = 1e300;
+  for (size_t r = 0; r < rounds; r++) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  return best;
+}
+
+void print_result(const char *variant, const char *dataset, size_t bytes, double seconds) {
+  fmt::print("{{\"variant\":\"{}\",\"dataset\":\"{}\",\"bytes\":{},\"mb_per_s\":{:.2f}}}\n", variant, dataset, bytes,
+             double(bytes) / seconds / 1e6);
+}
+
+template <typename T>
+int run(const char *dataset, const char *path, size_t rounds) {
+  simdjson::mapped_file file;
+  simdjson::ondemand::parser parser;
+  simdjson::ondemand::document doc;
+  T value;
+  if (simdjson::mapped_file::load(path).get(file) || parser.iterate(file.view()).get(doc) || doc.get(value)) {
+    fmt::print(stderr, "could not load {}\n", path);
+    return EXIT_FAILURE;
+  }
+  std::string out;
+  write(out, value);
+  // The output must read back as the same value.
+  simdjson::padded_string check(out);
+  T back;
+  bool round_trips = !parser.iterate(check).get(doc) && !doc.get(back);
+  if (round_trips) {
+    std::string again;
+    write(again, back);
+    round_trips = again == out;
+  }
+  if (!round_trips) {
+    fmt::print(stderr, "{}: the output does not round trip\n", path);
+    return EXIT_FAILURE;
+  }
+  const double best = best_seconds(rounds, [&] {
+    out.clear();
+    write(out, value);
+  });
+  print_result(ABLATION_VARIANT, dataset, out.size(), best);
+  if constexpr (ABLATION_CONSTEVAL_KEYS && ABLATION_SIMD_ESCAPE && ABLATION_FAST_DIGITS) {
+    // The reference: to_json() must give the same value back.
+    std::string json;
+    if (simdjson::to_json(value).get(json)) {
+      fmt::print(stderr, "{}: simdjson::to_json() failed\n", path);
+      return EXIT_FAILURE;
+    }
+    simdjson::padded_string reference_json(json);
+    if (parser.iterate(reference_json).get(doc) || doc.get(back)) {
+      fmt::print(stderr, "{}: simdjson::to_json() does not round trip\n", path);
+      return EXIT_FAILURE;
+    }
+    std::string again;
+    write(again, back);
+    if (again != out) {
+      fmt::print(stderr, "{}: simdjson::to_json() and this writer disagree\n", path);
+      return EXIT_FAILURE;
+    }
+    const double reference = best_seconds(rounds, [&] {
+      if (simdjson::to_json(value).get(json)) { std::abort(); }
+    });
+    print_result("simdjson_to_json", dataset, json.size(), reference);
+  }
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    fmt::print(stderr, "Usage: {} twitter|citm file.json [rounds]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  const std::string_view dataset = argv[1];
+  const size_t rounds = argc > 3 ? std::stoul(argv[3]) : 1000;
+  if (dataset == "twitter") { return run<TwitterFeed>("twitter.json", argv[2], rounds); }
+  if (dataset == "citm") { return run<CitmCatalog>("citm_catalog.json", argv[2], rounds); }
+  fmt::print(stderr, "unknown dataset {}\n", dataset);
+  return EXIT_FAILURE;
+}
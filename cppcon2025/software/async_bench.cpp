@@ -0,0 +1,144 @@
+// The same number of forecasts in flight, fetched and parsed two ways: one
+// thread per request blocked in curl_easy_perform (client_pool, as in
+// webservice_bench), then coroutines over curl multi on a few threads
+// (weather_loop). We report requests/s and the p50/p99/p99.9 latency.
+//
+// Usage: ./async_bench [concurrency] [requests] [loop_threads] [base_url]
+// Point base_url at a local mirror of the forecast endpoint before running
+// thousands of requests against it.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "weather_client.h"
+#include "weather_data.h"
+#include "weather_loop.h"
+
+double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) { return 0; }
+    size_t index = size_t(p * double(sorted.size() - 1));
+    return sorted[index];
+}
+
+// Fan out over a grid of lat/long lookups.
+void coordinates(size_t request, std::string &latitude, std::string &longitude) {
+    latitude.clear();
+    longitude.clear();
+    fmt::format_to(std::back_inserter(latitude), "{:.4f}", -60.0 + double(request % 120));
+    fmt::format_to(std::back_inserter(longitude), "{:.4f}", -180.0 + double(request % 360));
+}
+
+double since_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char *name, std::vector<std::vector<double>> &latencies, double elapsed) {
+    std::vector<double> all;
+    for (auto &mine : latencies) { all.insert(all.end(), mine.begin(), mine.end()); }
+    std::sort(all.begin(), all.end());
+    fmt::print("{:<24} {:>12.1f} {:>10.2f} {:>10.2f} {:>10.2f}\n", name, double(all.size()) / elapsed,
+        percentile(all, 0.50), percentile(all, 0.99), percentile(all, 0.999));
+}
+
+// Thread w of concurrency handles requests w, w + concurrency, ...
+void blocking(client_pool &pool, size_t concurrency, size_t requests, std::vector<std::vector<double>> &latencies) {
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < concurrency; w++) {
+        threads.emplace_back([&, w] {
+            std::string latitude, longitude;
+            for (size_t i = w; i < requests; i += concurrency) {
+                coordinates(i, latitude, longitude);
+                auto request_start = std::chrono::steady_clock::now();
+                auto client = pool.acquire();
+                simdjson::ondemand::document doc = client->iterate(latitude, longitude);
+                weather_data wd = doc["hourly"].get<weather_data>();
+                latencies[w].push_back(since_ms(request_start));
+            }
+        });
+    }
+    for (auto &thread : threads) { thread.join(); }
+}
+
+detached forecasts(weather_loop &loop, size_t first, size_t step, size_t requests, std::vector<double> &latencies, size_t &failures) {
+    std::string latitude, longitude;
+    for (size_t i = first; i < requests; i += step) {
+        coordinates(i, latitude, longitude);
+        auto request_start = std::chrono::steady_clock::now();
+        weather_loop::response reply = co_await loop.fetch(latitude, longitude);
+        if (reply.error() != CURLE_OK) {
+            failures++;
+            continue;
+        }
+        simdjson::ondemand::document doc;
+        weather_data wd;
+        if (loop.iterate(reply).get(doc) || doc["hourly"].get(wd)) {
+            failures++;
+            continue;
+        }
+        latencies.push_back(since_ms(request_start));
+    }
+}
+
+// Each thread runs one loop with its share of the coroutines; coroutine w
+// of concurrency handles requests w, w + concurrency, ...
+size_t coroutines(std::vector<std::unique_ptr<weather_loop>> &loops, size_t concurrency, size_t requests,
+        std::vector<std::vector<double>> &latencies) {
+    std::vector<std::thread> threads;
+    std::vector<size_t> failures(loops.size());
+    for (size_t t = 0; t < loops.size(); t++) {
+        threads.emplace_back([&, t] {
+            for (size_t w = t; w < concurrency; w += loops.size()) {
+                forecasts(*loops[t], w, concurrency, requests, latencies[w], failures[t]);
+            }
+            loops[t]->run();
+        });
+    }
+    for (auto &thread : threads) { thread.join(); }
+    size_t total = 0;
+    for (size_t f : failures) { total += f; }
+    return total;
+}
+
+int main(int argc, char **argv) {
+    size_t concurrency = argc > 1 ? std::stoul(argv[1]) : 256;
+    size_t requests = argc > 2 ? std::stoul(argv[2]) : 10 * concurrency;
+    size_t loop_threads = argc > 3 ? std::stoul(argv[3]) : std::min<size_t>(4, std::thread::hardware_concurrency());
+    std::string base_url = argc > 4 ? argv[4] : std::string(open_meteo_url);
+    loop_threads = std::clamp<size_t>(loop_threads, 1, concurrency);
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    fmt::print("# {} requests, {} in flight\n", requests, concurrency);
+    fmt::print("{:<24} {:>12} {:>10} {:>10} {:>10}\n", "", "requests/s", "p50 (ms)", "p99 (ms)", "p99.9 (ms)");
+    {
+        client_pool pool(concurrency, base_url);
+        // Warm up: one request per client opens its connection.
+        std::vector<std::vector<double>> warmup(concurrency);
+        blocking(pool, concurrency, concurrency, warmup);
+        std::vector<std::vector<double>> latencies(concurrency);
+        auto start = std::chrono::steady_clock::now();
+        blocking(pool, concurrency, requests, latencies);
+        report(fmt::format("{} threads, blocking", concurrency).c_str(), latencies, since_ms(start) / 1e3);
+    }
+    {
+        std::vector<std::unique_ptr<weather_loop>> loops;
+        for (size_t t = 0; t < loop_threads; t++) { loops.push_back(std::make_unique<weather_loop>(base_url)); }
+        // Warm up: as many connections as in flight, and the buffers.
+        std::vector<std::vector<double>> warmup(concurrency);
+        coroutines(loops, concurrency, concurrency, warmup);
+        std::vector<std::vector<double>> latencies(concurrency);
+        auto start = std::chrono::steady_clock::now();
+        size_t failures = coroutines(loops, concurrency, requests, latencies);
+        report(fmt::format("{} threads, curl multi", loop_threads).c_str(), latencies, since_ms(start) / 1e3);
+        if (failures > 0) { fmt::print("{} requests failed\n", failures); }
+    }
+    curl_global_cleanup();
+    return EXIT_SUCCESS;
+}
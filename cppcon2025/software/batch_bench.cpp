@@ -0,0 +1,77 @@
+// Batch serialization of Player records with simdjson::batch_serializer:
+// GB/s for 1..N threads, as NDJSON and as a JSON array. The last column
+// includes the writev() of the pieces to /dev/null.
+//
+// Usage: ./batch_bench [players] [max_threads]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "batch_serialize.h"
+#include "player.h"
+#include "thread_pool.h"
+
+std::vector<Player> random_players(size_t count) {
+  std::mt19937 rng(1234);
+  auto text = [&rng](size_t length) {
+    std::string s(length, ' ');
+    for (char &c : s) { c = char('a' + rng() % 26); }
+    return s;
+  };
+  std::vector<Player> players;
+  players.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    Player p{text(4 + rng() % 16), int(rng() % 100), double(rng() % 1000) / 10.0, {}};
+    for (size_t j = rng() % 6; j > 0; j--) { p.inventory.push_back(text(4 + rng() % 12)); }
+    players.push_back(std::move(p));
+  }
+  return players;
+}
+
+template <typename F>
+double best_seconds(F f) {
+  double best = 1e300;
+  for (int round = 0; round < 5; round++) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  return best;
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  size_t max_threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+  std::vector<Player> players = random_players(count);
+  int dev_null = open("/dev/null", O_WRONLY);
+  if (dev_null < 0) { return EXIT_FAILURE; }
+  fmt::print("# {} players\n", count);
+  fmt::print("{:>8} {:>12} {:>16} {:>18}\n", "threads", "format", "serialize GB/s", "+ writev GB/s");
+  for (size_t threads = 1; threads <= max_threads; threads++) {
+    thread_pool pool(threads);
+    simdjson::batch_serializer<Player> out(pool);
+    for (auto format : {simdjson::batch_format::ndjson, simdjson::batch_format::json_array}) {
+      if (out.serialize(players, format)) { return EXIT_FAILURE; } // warm up the builders
+      const double volume = double(out.size());
+      double serialize = best_seconds([&] { (void)out.serialize(players, format); });
+      double with_write = best_seconds([&] {
+        (void)out.serialize(players, format);
+        (void)out.write_to(dev_null);
+      });
+      fmt::print("{:>8} {:>12} {:>16.2f} {:>18.2f}\n", threads,
+                 format == simdjson::batch_format::ndjson ? "ndjson" : "json array",
+                 volume / serialize / 1e9, volume / with_write / 1e9);
+    }
+  }
+  close(dev_null);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <simdjson.h>
+
+#include "thread_pool.h"
+
+/**
+ * Serializes a span of reflected structs as NDJSON (one record per line) or
+ * as a JSON array, in parallel. The records are cut into contiguous chunks
+ * and every chunk goes to its own string_builder, owned by the serializer
+ * and reused across calls. The output is never concatenated: pieces()
+ * describes it as an iovec list that write_to() hands to writev(), the
+ * kernel gathers the pieces straight from the builders.
+ *
+ *   simdjson::batch_serializer<Player> out(pool);
+ *   out.serialize(players, simdjson::batch_format::ndjson);
+ *   out.write_to(fd);
+ */
+namespace simdjson {
+
+enum class batch_format { ndjson, json_array };
+
+template <typename T>
+class batch_serializer {
+public:
+    // More chunks than threads, so that uneven records balance out.
+    static constexpr size_t chunks_per_thread = 4;
+
+    explicit batch_serializer(thread_pool &workers) : pool(workers) {}
+
+    error_code serialize(std::span<const T> records, batch_format format) {
+        const size_t chunk_count = std::min(records.size(), std::max<size_t>(1, pool.size()) * chunks_per_thread);
+        while (builders.size() < chunk_count) {
+            builders.push_back(std::make_unique<builder::string_builder>());
+        }
+        pool.parallel_for(chunk_count, [&](size_t chunk) {
+            const size_t begin = records.size() * chunk / chunk_count;
+            const size_t end = records.size() * (chunk + 1) / chunk_count;
+            builder::string_builder &b = *builders[chunk];
+            b.clear();
+            for (size_t i = begin; i < end; i++) {
+                if (format == batch_format::json_array && i != begin) { b.append(','); }
+                b.append(records[i]);
+                if (format == batch_format::ndjson) { b.append('\n'); }
+            }
+        });
+        output.clear();
+        output.reserve(2 * chunk_count + 2);
+        static constexpr std::string_view open_bracket = "[", comma = ",", close_bracket = "]";
+        if (format == batch_format::json_array) { push(open_bracket); }
+        for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+            std::string_view piece;
+            auto error = builders[chunk]->view().get(piece);
+            if (error) { return error; }
+            if (format == batch_format::json_array && chunk > 0) { push(comma); }
+            push(piece);
+        }
+        if (format == batch_format::json_array) { push(close_bracket); }
+        return SUCCESS;
+    }
+
+    // Valid until the next serialize().
+    std::span<const iovec> pieces() const { return output; }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const iovec &piece : output) { total += piece.iov_len; }
+        return total;
+    }
+
+    // Writes everything to a file or a socket, resuming after short writes.
+    error_code write_to(int fd) const {
+        std::vector<iovec> pending(output.begin(), output.end());
+        size_t first = 0;
+        while (first < pending.size()) {
+            const int count = int(std::min<size_t>(pending.size() - first, IOV_MAX));
+            ssize_t written = writev(fd, pending.data() + first, count);
+            if (written < 0) {
+                if (errno == EINTR) { continue; }
+                return IO_ERROR;
+            }
+            for (size_t left = size_t(written); left > 0 && first < pending.size();) {
+                iovec &piece = pending[first];
+                const size_t consumed = std::min(left, piece.iov_len);
+                piece.iov_base = static_cast<char *>(piece.iov_base) + consumed;
+                piece.iov_len -= consumed;
+                left -= consumed;
+                if (piece.iov_len == 0) { first++; }
+            }
+            while (first < pending.size() && pending[first].iov_len == 0) { first++; }
+        }
+        return SUCCESS;
+    }
+
+private:
+    void push(std::string_view piece) {
+        output.push_back(iovec{const_cast<char *>(piece.data()), piece.size()});
+    }
+
+    thread_pool &pool;
+    std::vector<std::unique_ptr<builder::string_builder>> builders;
+    std::vector<iovec> output;
+};
+
+} // namespace simdjson
@@ -0,0 +1,98 @@
+// The binary format of binary_format.h against the JSON path, both ways,
+// on twitter.json and on a week of hourly forecasts.
+//
+// Usage: ./binary_bench [twitter.json]
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "binary_format.h"
+#include "mapped_file.h"
+#include "twitter_data.h"
+#include "weather_data.h"
+
+// Microseconds per call, repeated for at least half a second.
+template <typename F>
+double time_us(F f) {
+  f(); // warm up
+  size_t rounds = 0;
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed{};
+  do {
+    f();
+    rounds++;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.5);
+  return elapsed.count() * 1e6 / double(rounds);
+}
+
+template <typename T>
+void compare(const char *name, const T &value) {
+  const std::string json_text = simdjson::to_json(value);
+  const simdjson::padded_string json(json_text);
+  const std::string binary = simdjson::to_binary(value);
+  T check;
+  if (simdjson::from_binary(binary, check) || simdjson::to_binary(check) != binary) {
+    fmt::print(stderr, "{}: binary round trip failed\n", name);
+    std::exit(EXIT_FAILURE);
+  }
+  simdjson::ondemand::parser parser;
+  T out;
+  const double to_json_us = time_us([&] {
+    std::string s = simdjson::to_json(value);
+    asm volatile("" : : "r"(s.data()) : "memory");
+  });
+  const double from_json_us = time_us([&] {
+    simdjson::ondemand::document doc;
+    if (parser.iterate(json).get(doc) || doc.get(out)) { std::abort(); }
+  });
+  std::string scratch;
+  const double to_binary_us = time_us([&] {
+    scratch.clear();
+    simdjson::to_binary_into(value, scratch);
+    asm volatile("" : : "r"(scratch.data()) : "memory");
+  });
+  const double from_binary_us = time_us([&] {
+    if (simdjson::from_binary(binary, out)) { std::abort(); }
+  });
+  fmt::print("# {}\n", name);
+  fmt::print("{:<8} {:>12} {:>14} {:>14}\n", "format", "bytes", "serialize us", "parse us");
+  fmt::print("{:<8} {:>12} {:>14.2f} {:>14.2f}\n", "json", json_text.size(), to_json_us, from_json_us);
+  fmt::print("{:<8} {:>12} {:>14.2f} {:>14.2f}\n", "binary", binary.size(), to_binary_us, from_binary_us);
+}
+
+weather_data random_week() {
+  std::mt19937 rng(1234);
+  weather_data wd;
+  for (int day = 1; day <= 7; day++) {
+    for (int hour = 0; hour < 24; hour++) {
+      wd.time.push_back(fmt::format("2025-09-{:02}T{:02}:00", day, hour));
+      wd.temperature_2m.push_back(float(int(rng() % 400) - 100) / 10.0f);
+      wd.relative_humidity_2m.push_back(float(rng() % 101));
+      wd.winddirection_10m.push_back(float(rng() % 360));
+      wd.precipitation.push_back(float(rng() % 50) / 10.0f);
+      wd.windspeed_10m.push_back(float(rng() % 600) / 10.0f);
+    }
+  }
+  return wd;
+}
+
+int main(int argc, char **argv) {
+  const char *path = argc > 1 ? argv[1] : TWITTER_JSON;
+  simdjson::mapped_file file;
+  TwitterFeed feed;
+  simdjson::ondemand::parser parser;
+  simdjson::ondemand::document doc;
+  if (simdjson::mapped_file::load(path).get(file) || parser.iterate(file.view()).get(doc) || doc.get(feed)) {
+    fmt::print(stderr, "could not load {}\n", path);
+    return EXIT_FAILURE;
+  }
+  compare("twitter.json statuses", feed);
+  compare("weather_data, 168 hours", random_week());
+  return EXIT_SUCCESS;
+}
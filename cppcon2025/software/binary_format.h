@@ -0,0 +1,218 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <meta>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <simdjson.h>
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * A compact binary encoding for hops between our own services, driven by
+ * the same reflection as to_json() and from():
+ *
+ *   std::string bytes = simdjson::to_binary(player);
+ *   Player p;
+ *   auto error = simdjson::from_binary(bytes, p);
+ *
+ * Layout, little endian:
+ *  - bool: one byte; integers and floating point: their raw bytes;
+ *  - strings: u32 length, then the bytes;
+ *  - vectors of numbers: u32 count, then the elements in one memcpy (the
+ *    float columns of weather_data go through as they are in memory);
+ *    other vectors: u32 count, then the elements;
+ *  - std::optional: one presence byte, then the value;
+ *  - structs: u32 member count, then per member a u32 tag (the FNV-1a hash
+ *    of its name, computed at compile time), the u32 size of the value and
+ *    the value.
+ *
+ * Tags and sizes let either side evolve: members are matched by tag, not
+ * position, unknown tags are skipped, absent members keep their value.
+ * Truncated input is OUT_OF_BOUNDS, a value that does not fill its size is
+ * INCORRECT_TYPE.
+ */
+namespace simdjson {
+namespace binary_details {
+
+static_assert(std::endian::native == std::endian::little, "the binary format is little endian");
+
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_number = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+template <typename T>
+inline constexpr auto members = std::define_static_array(
+    std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()));
+
+consteval uint32_t tag_of(std::string_view name) {
+  uint32_t h = 2166136261u;
+  for (char c : name) { h = (h ^ uint8_t(c)) * 16777619u; }
+  return h;
+}
+
+template <typename T>
+consteval bool tags_are_unique() {
+  for (size_t i = 0; i < members<T>.size(); i++) {
+    for (size_t j = i + 1; j < members<T>.size(); j++) {
+      if (tag_of(std::meta::identifier_of(members<T>[i])) == tag_of(std::meta::identifier_of(members<T>[j]))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+inline void put(std::string &out, const void *data, size_t size) {
+  out.append(static_cast<const char *>(data), size);
+}
+
+inline void put_u32(std::string &out, uint32_t v) { put(out, &v, sizeof(v)); }
+
+template <typename T>
+void encode(std::string &out, const T &value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    out += char(value ? 1 : 0);
+  } else if constexpr (is_number<T>) {
+    put(out, &value, sizeof(value));
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    put_u32(out, uint32_t(value.size()));
+    out.append(value);
+  } else if constexpr (is_optional<T>::value) {
+    out += char(value.has_value() ? 1 : 0);
+    if (value) { encode(out, *value); }
+  } else if constexpr (is_vector<T>::value && is_number<typename T::value_type>) {
+    put_u32(out, uint32_t(value.size()));
+    put(out, value.data(), value.size() * sizeof(typename T::value_type));
+  } else if constexpr (is_vector<T>::value) {
+    put_u32(out, uint32_t(value.size()));
+    for (const auto &element : value) { encode(out, element); }
+  } else {
+    static_assert(std::is_aggregate_v<T>, "to_binary handles the types listed in binary_format.h");
+    static_assert(tags_are_unique<T>(), "two member names of this type hash to the same tag");
+    put_u32(out, uint32_t(members<T>.size()));
+    template for (constexpr auto member : members<T>) {
+      put_u32(out, tag_of(std::meta::identifier_of(member)));
+      // The size is known once the value is written.
+      const size_t size_at = out.size();
+      put_u32(out, 0);
+      encode(out, value.[:member:]);
+      const uint32_t size = uint32_t(out.size() - size_at - sizeof(uint32_t));
+      std::memcpy(out.data() + size_at, &size, sizeof(size));
+    }
+  }
+}
+
+struct reader {
+  const char *p;
+  const char *end;
+
+  bool take(void *out, size_t size) {
+    if (size_t(end - p) < size) { return false; }
+    std::memcpy(out, p, size);
+    p += size;
+    return true;
+  }
+  bool take_u32(uint32_t &v) { return take(&v, sizeof(v)); }
+};
+
+template <typename T>
+error_code decode(reader &in, T &out) {
+  if constexpr (std::is_same_v<T, bool>) {
+    uint8_t b;
+    if (!in.take(&b, 1)) { return OUT_OF_BOUNDS; }
+    out = b != 0;
+  } else if constexpr (is_number<T>) {
+    if (!in.take(&out, sizeof(out))) { return OUT_OF_BOUNDS; }
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    uint32_t size;
+    if (!in.take_u32(size) || size_t(in.end - in.p) < size) { return OUT_OF_BOUNDS; }
+    out.assign(in.p, size);
+    in.p += size;
+  } else if constexpr (is_optional<T>::value) {
+    uint8_t present;
+    if (!in.take(&present, 1)) { return OUT_OF_BOUNDS; }
+    if (!present) {
+      out.reset();
+    } else {
+      return decode(in, out.emplace());
+    }
+  } else if constexpr (is_vector<T>::value && is_number<typename T::value_type>) {
+    uint32_t count;
+    if (!in.take_u32(count)) { return OUT_OF_BOUNDS; }
+    const size_t bytes = size_t(count) * sizeof(typename T::value_type);
+    if (size_t(in.end - in.p) < bytes) { return OUT_OF_BOUNDS; }
+    out.resize(count);
+    std::memcpy(out.data(), in.p, bytes);
+    in.p += bytes;
+  } else if constexpr (is_vector<T>::value) {
+    uint32_t count;
+    if (!in.take_u32(count)) { return OUT_OF_BOUNDS; }
+    // Every element takes at least a byte: do not trust a huge count.
+    if (size_t(in.end - in.p) < count) { return OUT_OF_BOUNDS; }
+    out.resize(count);
+    for (auto &element : out) {
+      auto error = decode(in, element);
+      if (error) { return error; }
+    }
+  } else {
+    uint32_t count;
+    if (!in.take_u32(count)) { return OUT_OF_BOUNDS; }
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t tag, size;
+      if (!in.take_u32(tag) || !in.take_u32(size) || size_t(in.end - in.p) < size) { return OUT_OF_BOUNDS; }
+      reader value{in.p, in.p + size};
+      in.p += size;
+      error_code error = SUCCESS;
+      template for (constexpr auto member : members<T>) {
+        if (tag == tag_of(std::meta::identifier_of(member))) {
+          error = decode(value, out.[:member:]);
+          if (!error && value.p != value.end) { error = INCORRECT_TYPE; }
+        }
+      }
+      if (error) { return error; }
+    }
+  }
+  return SUCCESS;
+}
+
+} // namespace binary_details
+
+template <typename T>
+void to_binary_into(const T &value, std::string &out) {
+  binary_details::encode(out, value);
+}
+
+template <typename T>
+std::string to_binary(const T &value) {
+  std::string out;
+  binary_details::encode(out, value);
+  return out;
+}
+
+template <typename T>
+error_code from_binary(std::string_view bytes, T &out) {
+  binary_details::reader in{bytes.data(), bytes.data() + bytes.size()};
+  auto error = binary_details::decode(in, out);
+  if (error) { return error; }
+  return in.p == in.end ? SUCCESS : INCORRECT_TYPE;
+}
+
+} // namespace simdjson
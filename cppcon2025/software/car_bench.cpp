@@ -0,0 +1,95 @@
+// Runtime comparison of serialize_manual() and serialize_reflection() from
+// compiler_explorer_manual_vs_reflection.cpp: the instruction counts in
+// instruction_count_analysis.md are static, here we measure throughput.
+//
+// Usage: ./car_bench [cars] [rounds]
+// Each escape density (escapes per thousand string bytes) gets its own run.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+// We measure exactly the code whose assembly was analyzed.
+#include "../compiler_explorer_manual_vs_reflection.cpp"
+#include "perf_counters.h"
+#include "reusable_to_json.h"
+
+std::string random_text(std::mt19937 &rng, size_t length, unsigned escape_per_mille) {
+    static constexpr std::string_view needs_escaping = "\"\\\n\t\x01";
+    std::string text(length, ' ');
+    for (char &c : text) {
+        if (rng() % 1000 < escape_per_mille) {
+            c = needs_escaping[rng() % needs_escaping.size()];
+        } else {
+            c = char('a' + rng() % 26);
+        }
+    }
+    return text;
+}
+
+std::vector<Car> random_cars(size_t count, unsigned escape_per_mille) {
+    std::mt19937 rng(1234);
+    std::vector<Car> cars;
+    cars.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        Car car{random_text(rng, 1 + rng() % 64, escape_per_mille),
+                random_text(rng, 1 + rng() % 64, escape_per_mille),
+                int(1950 + rng() % 75), {}};
+        for (size_t j = rng() % 8; j > 0; j--) {
+            car.tire_pressure.push_back(float(rng() % 500) / 10.0f);
+        }
+        cars.push_back(std::move(car));
+    }
+    return cars;
+}
+
+template <typename F>
+void bench(const char *name, const std::vector<Car> &cars, size_t rounds, F serialize) {
+    size_t volume = 0;
+    // Warm up.
+    for (const Car &car : cars) { volume += serialize(car).size(); }
+    perf_counters counters;
+    counters.start();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (const Car &car : cars) {
+            auto json = serialize(car);
+            asm volatile("" : : "r"(json.data()) : "memory");
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    perf_counters::sample sample = counters.stop();
+    double ops = double(cars.size()) * double(rounds);
+    fmt::print("{:<22} {:>10.2f} {:>10.3f}", name, seconds * 1e9 / ops, double(volume) * double(rounds) / seconds / 1e9);
+    if (counters.available()) {
+        fmt::print(" {:>8.2f} {:>16.3f}\n", sample.instructions_per_cycle(), double(sample.branch_misses) / ops);
+    } else {
+        fmt::print(" {:>8} {:>16}\n", "n/a", "n/a");
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 3;
+    for (unsigned escape_per_mille : {0u, 1u, 10u, 100u}) {
+        std::vector<Car> cars = random_cars(count, escape_per_mille);
+        fmt::print("# {} cars, {} rounds, {} escapes per thousand bytes\n", count, rounds, escape_per_mille);
+        fmt::print("{:<22} {:>10} {:>10} {:>8} {:>16}\n", "", "ns/op", "GB/s", "IPC", "branch misses/op");
+        bench("serialize_manual", cars, rounds, serialize_manual);
+        bench("serialize_reflection", cars, rounds, serialize_reflection);
+        // Same serializer, but into one builder sized once from the bound.
+        size_t bound = 0;
+        for (const Car &car : cars) { bound = std::max(bound, simdjson::json_size_bound(car)); }
+        simdjson::builder::string_builder b(bound);
+        bench("to_json_into (reused)", cars, rounds, [&b](const Car &car) {
+            std::string_view json;
+            if (simdjson::to_json_into(car, b).get(json)) { std::abort(); }
+            return json;
+        });
+    }
+    return EXIT_SUCCESS;
+}
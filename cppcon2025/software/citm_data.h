@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// citm_catalog.json, from the simdjson benchmark files (jsonexamples/):
+// mostly integers and maps keyed by numeric ids, few escapes.
+struct CitmEvent {
+  std::optional<std::string> description;
+  int64_t id;
+  std::optional<std::string> logo;
+  std::string name;
+  std::vector<int64_t> subTopicIds;
+  std::optional<std::string> subjectCode;
+  std::optional<std::string> subtitle;
+  std::vector<int64_t> topicIds;
+};
+
+struct CitmPrice {
+  int64_t amount;
+  int64_t audienceSubCategoryId;
+  int64_t seatCategoryId;
+};
+
+struct CitmArea {
+  int64_t areaId;
+  std::vector<int64_t> blockIds;
+};
+
+struct CitmSeatCategory {
+  std::vector<CitmArea> areas;
+  int64_t seatCategoryId;
+};
+
+struct CitmPerformance {
+  int64_t eventId;
+  int64_t id;
+  std::optional<std::string> logo;
+  std::optional<std::string> name;
+  std::vector<CitmPrice> prices;
+  std::vector<CitmSeatCategory> seatCategories;
+  std::optional<std::string> seatMapImage;
+  int64_t start;
+  std::string venueCode;
+};
+
+struct CitmCatalog {
+  std::map<std::string, std::string> areaNames;
+  std::map<std::string, std::string> audienceSubCategoryNames;
+  std::map<std::string, std::string> blockNames;
+  std::map<std::string, CitmEvent> events;
+  std::vector<CitmPerformance> performances;
+  std::map<std::string, std::string> seatCategoryNames;
+  std::map<std::string, std::string> subTopicNames;
+  std::map<std::string, std::string> subjectNames;
+  std::map<std::string, std::string> topicNames;
+  std::map<std::string, std::vector<int64_t>> topicSubTopics;
+  std::map<std::string, std::string> venueNames;
+};
@@ -0,0 +1,45 @@
+# The serialization ablation study (ablation_bench.cpp): one binary with
+# every optimization, one per optimization compiled out, run on twitter.json
+# and citm_catalog.json. The results go to ablation.json in the build
+# directory, for images/generate_perf_charts.py.
+#
+#   cmake --build build --target ablation
+#
+# citm_catalog.json is not part of this repository (it is in simdjson's
+# jsonexamples/); point ABLATION_CITM_JSON at a copy, it is skipped otherwise.
+
+set(ABLATION_TWITTER_JSON "${CMAKE_CURRENT_SOURCE_DIR}/../go/twitter.json" CACHE FILEPATH "twitter.json for the ablation target")
+set(ABLATION_CITM_JSON "${CMAKE_CURRENT_SOURCE_DIR}/../data/citm_catalog.json" CACHE FILEPATH "citm_catalog.json for the ablation target")
+set(ABLATION_ROUNDS 1000 CACHE STRING "Serializations per variant and file in the ablation target, the best one counts")
+
+set(ablation_variants baseline no_consteval_keys no_simd_escape no_fast_digits)
+set(ablation_binaries)
+foreach(variant ${ablation_variants})
+  set(target ablation_${variant})
+  add_executable(${target} EXCLUDE_FROM_ALL ablation_bench.cpp)
+  target_link_libraries(${target} PRIVATE fmt::fmt)
+  target_link_libraries(${target} PRIVATE simdjson::simdjson)
+  target_compile_definitions(${target} PRIVATE ABLATION_VARIANT="${variant}")
+  if(variant STREQUAL no_consteval_keys)
+    target_compile_definitions(${target} PRIVATE ABLATION_CONSTEVAL_KEYS=0)
+  elseif(variant STREQUAL no_simd_escape)
+    target_compile_definitions(${target} PRIVATE ABLATION_SIMD_ESCAPE=0)
+  elseif(variant STREQUAL no_fast_digits)
+    target_compile_definitions(${target} PRIVATE ABLATION_FAST_DIGITS=0)
+  endif()
+  list(APPEND ablation_binaries $<TARGET_FILE:${target}>)
+endforeach()
+
+list(JOIN ablation_binaries "|" ablation_binary_list)
+add_custom_target(ablation
+  COMMAND ${CMAKE_COMMAND}
+    "-DBINARIES=${ablation_binary_list}"
+    -DTWITTER=${ABLATION_TWITTER_JSON}
+    -DCITM=${ABLATION_CITM_JSON}
+    -DROUNDS=${ABLATION_ROUNDS}
+    -DOUTPUT=${CMAKE_CURRENT_BINARY_DIR}/ablation.json
+    -P ${CMAKE_CURRENT_LIST_DIR}/ablation_run.cmake
+  VERBATIM)
+foreach(variant ${ablation_variants})
+  add_dependencies(ablation ablation_${variant})
+endforeach()
@@ -0,0 +1,37 @@
+# Runs the ablation binaries (see ablation.cmake) on each file that exists
+# and writes their results, with the host, as one JSON document:
+#   {"host": ..., "processor": ..., "results": [{"variant": ..., "dataset": ...,
+#    "bytes": ..., "mb_per_s": ...}, ...]}
+# A binary prints one result per line (the baseline adds simdjson_to_json).
+
+string(REPLACE "|" ";" binaries "${BINARIES}")
+cmake_host_system_information(RESULT host QUERY HOSTNAME)
+cmake_host_system_information(RESULT processor QUERY PROCESSOR_DESCRIPTION)
+
+set(results)
+foreach(dataset twitter citm)
+  string(TOUPPER ${dataset} variable)
+  set(file "${${variable}}")
+  if(NOT EXISTS "${file}")
+    message(STATUS "ablation: no ${file}, skipping ${dataset}")
+    continue()
+  endif()
+  foreach(binary ${binaries})
+    execute_process(COMMAND ${binary} ${dataset} ${file} ${ROUNDS}
+                    OUTPUT_VARIABLE output
+                    RESULT_VARIABLE status
+                    OUTPUT_STRIP_TRAILING_WHITESPACE)
+    if(NOT status EQUAL 0)
+      message(FATAL_ERROR "ablation: ${binary} failed on ${file}")
+    endif()
+    string(REPLACE "\n" ";" lines "${output}")
+    foreach(line ${lines})
+      message(STATUS "ablation: ${line}")
+      list(APPEND results "    ${line}")
+    endforeach()
+  endforeach()
+endforeach()
+
+list(JOIN results ",\n" body)
+file(WRITE ${OUTPUT} "{\n  \"host\": \"${host}\",\n  \"processor\": \"${processor}\",\n  \"results\": [\n${body}\n  ]\n}\n")
+message(STATUS "ablation: wrote ${OUTPUT}")
@@ -0,0 +1,76 @@
+# Compile time and object size of reflecting COMPILE_BENCH_STRUCTS synthetic
+# structs, each serialized and deserialized in COMPILE_BENCH_UNITS translation
+# units, built twice from the same sources:
+#  - compile_bench_implicit: every unit instantiates simdjson::reflected<S>;
+#  - compile_bench_explicit: units see SIMDJSON_EXTERN_REFLECTED(S), one more
+#    unit holds the SIMDJSON_INSTANTIATE_REFLECTED(S) (reflected_instantiation.h).
+#
+#   cmake --build build --target compile_bench
+#
+# Units that did not change are not rebuilt, their last timings are reported.
+
+set(COMPILE_BENCH_STRUCTS 100 CACHE STRING "Synthetic structs reflected by the compile_bench target")
+set(COMPILE_BENCH_UNITS 8 CACHE STRING "Translation units using every struct in the compile_bench target")
+
+set(compile_bench_dir ${CMAKE_CURRENT_BINARY_DIR}/compile_bench)
+
+# Rewrites file only when content changed, so reconfiguring does not
+# invalidate the timings.
+function(compile_bench_write file content)
+  if(EXISTS ${file})
+    file(READ ${file} existing)
+    if(existing STREQUAL content)
+      return()
+    endif()
+  endif()
+  file(WRITE ${file} "${content}")
+endfunction()
+
+set(structs "#pragma once\n\n#include <cstdint>\n#include <string>\n#include <vector>\n#include \"reflected_instantiation.h\"\n\n")
+set(instantiations "#include \"structs.h\"\n\n")
+foreach(s RANGE 1 ${COMPILE_BENCH_STRUCTS})
+  string(APPEND structs "struct S${s} {\n  int64_t id;\n  std::string name;\n  double score;\n  bool active;\n  std::vector<int> values;\n};\n")
+  string(APPEND structs "#ifdef COMPILE_BENCH_EXTERN\nSIMDJSON_EXTERN_REFLECTED(S${s});\n#endif\n\n")
+  string(APPEND instantiations "SIMDJSON_INSTANTIATE_REFLECTED(S${s});\n")
+endforeach()
+compile_bench_write(${compile_bench_dir}/structs.h "${structs}")
+compile_bench_write(${compile_bench_dir}/instantiate.cpp "${instantiations}")
+
+set(compile_bench_units)
+foreach(u RANGE 1 ${COMPILE_BENCH_UNITS})
+  set(unit "#include <string_view>\n#include \"structs.h\"\n\n")
+  foreach(s RANGE 1 ${COMPILE_BENCH_STRUCTS})
+    string(APPEND unit "size_t unit${u}_s${s}(simdjson::ondemand::document &doc) {\n")
+    string(APPEND unit "  S${s} value{};\n")
+    string(APPEND unit "  if (simdjson::reflected<S${s}>::from(doc, value)) { return 0; }\n")
+    string(APPEND unit "  simdjson::builder::string_builder b;\n")
+    string(APPEND unit "  simdjson::reflected<S${s}>::append(b, value);\n")
+    string(APPEND unit "  std::string_view json;\n")
+    string(APPEND unit "  return b.view().get(json) ? 0 : json.size();\n}\n\n")
+  endforeach()
+  compile_bench_write(${compile_bench_dir}/unit${u}.cpp "${unit}")
+  list(APPEND compile_bench_units ${compile_bench_dir}/unit${u}.cpp)
+endforeach()
+
+foreach(mode implicit explicit)
+  set(target compile_bench_${mode})
+  if(mode STREQUAL explicit)
+    add_library(${target} OBJECT EXCLUDE_FROM_ALL ${compile_bench_units} ${compile_bench_dir}/instantiate.cpp)
+    target_compile_definitions(${target} PRIVATE COMPILE_BENCH_EXTERN)
+  else()
+    add_library(${target} OBJECT EXCLUDE_FROM_ALL ${compile_bench_units})
+  endif()
+  target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_SOURCE_DIR} ${compile_bench_dir})
+  target_link_libraries(${target} PRIVATE simdjson::simdjson)
+  set_property(TARGET ${target} PROPERTY RULE_LAUNCH_COMPILE "sh ${CMAKE_CURRENT_LIST_DIR}/time_compile.sh")
+endforeach()
+
+add_custom_target(compile_bench
+  COMMAND ${CMAKE_COMMAND}
+    -DSTRUCTS=${COMPILE_BENCH_STRUCTS}
+    -DUNITS=${COMPILE_BENCH_UNITS}
+    "-DIMPLICIT=$<JOIN:$<TARGET_OBJECTS:compile_bench_implicit>,|>"
+    "-DEXPLICIT=$<JOIN:$<TARGET_OBJECTS:compile_bench_explicit>,|>"
+    -P ${CMAKE_CURRENT_LIST_DIR}/compile_bench_report.cmake
+  DEPENDS compile_bench_implicit compile_bench_explicit
+  VERBATIM)
@@ -0,0 +1,38 @@
+# Prints the table of the compile_bench target (see compile_bench.cmake), from
+# the objects and the .ms files time_compile.sh left next to them.
+
+# Right-aligns value in width columns.
+function(column out value width)
+  string(LENGTH "${value}" length)
+  set(padded "${value}")
+  if(length LESS width)
+    math(EXPR missing "${width} - ${length}")
+    string(REPEAT " " ${missing} spaces)
+    set(padded "${spaces}${value}")
+  endif()
+  set(${out} "${padded}" PARENT_SCOPE)
+endfunction()
+
+message("compile_bench: ${STRUCTS} structs, ${UNITS} units")
+message("mode      objects  compile ms  object bytes")
+foreach(mode implicit explicit)
+  string(TOUPPER ${mode} variable)
+  string(REPLACE "|" ";" objects "${${variable}}")
+  set(count 0)
+  set(milliseconds 0)
+  set(bytes 0)
+  foreach(object ${objects})
+    math(EXPR count "${count} + 1")
+    file(SIZE ${object} size)
+    math(EXPR bytes "${bytes} + ${size}")
+    if(EXISTS ${object}.ms)
+      file(READ ${object}.ms ms)
+      string(STRIP "${ms}" ms)
+      math(EXPR milliseconds "${milliseconds} + ${ms}")
+    endif()
+  endforeach()
+  column(count "${count}" 7)
+  column(milliseconds "${milliseconds}" 11)
+  column(bytes "${bytes}" 13)
+  message("${mode}  ${count} ${milliseconds} ${bytes}")
+endforeach()
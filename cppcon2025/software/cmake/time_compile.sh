@@ -0,0 +1,13 @@
+#!/bin/sh
+# Compiler launcher for the compile_bench targets: runs the compile command
+# and writes its wall time, in milliseconds, next to the object file.
+obj=
+prev=
+for arg in "$@"; do
+  if [ "$prev" = "-o" ]; then obj=$arg; fi
+  prev=$arg
+done
+start=$(date +%s%N)
+"$@" || exit $?
+end=$(date +%s%N)
+if [ -n "$obj" ]; then echo $(( (end - start) / 1000000 )) > "$obj.ms"; fi
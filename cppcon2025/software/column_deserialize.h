@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <simdjson.h>
+
+#include "decimal_parse.h"
+#include "instrumentation.h"
+#include "iso8601_parse.h"
+
+/**
+ * Columnar fast path for std::vector<float> and std::vector<double> (or
+ * std::pmr::vector) columns. We count the elements first so that the
+ * column is sized exactly once, then write each number straight into the
+ * column storage. Short decimals go through decimal_parse, everything else
+ * through get_double(); the two are counted as decimals_parsed_fast and
+ * decimals_parsed_fallback.
+ *
+ * It is not a tag_invoke, which would change how every float vector is
+ * parsed in the translation units that include this header. Types opt in
+ * instead: the key_table.h deserializers use it for their float column
+ * members (weather_data.h opts the hourly structs in), pmr.h for
+ * std::pmr::vector<float|double>.
+ */
+namespace simdjson {
+namespace column_details {
+
+template <typename Column>
+concept float_column = (std::is_same_v<typename Column::value_type, float> ||
+                        std::is_same_v<typename Column::value_type, double>) &&
+                       requires(Column &c, size_t n) {
+                         c.resize(n);
+                         c.data();
+                       };
+
+} // namespace column_details
+
+template <typename simdjson_value, typename Column>
+  requires column_details::float_column<Column>
+error_code deserialize_column(simdjson_value &val, Column &column) {
+    using F = typename Column::value_type;
+    ondemand::array array;
+    auto error = val.get_array().get(array);
+    if(error) { return error; }
+    size_t count;
+    // count_elements() rewinds the array, we can iterate it afterwards.
+    error = array.count_elements().get(count);
+    if(error) { return error; }
+    column.resize(count);
+    F *out = column.data();
+    size_t fallbacks = 0;
+    for (auto element : array) {
+        ondemand::value value;
+        error = element.get(value);
+        if(error) { return error; }
+        std::string_view token;
+        double number;
+        if (value.raw_json_token().get(token) || !decimal_parse::parse_short_decimal(token, number)) {
+            fallbacks++;
+            error = value.get_double().get(number);
+            if(error) { return error; }
+        }
+        *out++ = F(number);
+    }
+    instrumentation::add(instrumentation::decimals_parsed_fast, count - fallbacks);
+    instrumentation::add(instrumentation::decimals_parsed_fallback, fallbacks);
+  return simdjson::SUCCESS;
+}
+} // namespace simdjson
+
+/**
+ * A column of "YYYY-MM-DDTHH:MM" timestamps stored as minutes since the
+ * epoch: sorting and joining compare integers instead of 16-byte strings.
+ * Use it in place of std::vector<std::string> for the time member.
+ */
+struct epoch_minutes_column {
+    std::vector<int64_t> minutes;
+};
+
+namespace simdjson {
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, epoch_minutes_column &column) {
+    ondemand::array array;
+    auto error = val.get_array().get(array);
+    if(error) { return error; }
+    size_t count;
+    error = array.count_elements().get(count);
+    if(error) { return error; }
+    column.minutes.resize(count);
+    int64_t *out = column.minutes.data();
+    for (auto element : array) {
+        ondemand::value value;
+        error = element.get(value);
+        if(error) { return error; }
+        // The raw token is the quoted timestamp, possibly followed by whitespace.
+        std::string_view token;
+        error = value.raw_json_token().get(token);
+        if(error) { return error; }
+        if (token.size() < iso8601::timestamp_length + 2 || token[0] != '"' ||
+            token[iso8601::timestamp_length + 1] != '"' ||
+            !iso8601::parse_timestamp(token.data() + 1, *out)) {
+            return simdjson::INCORRECT_TYPE;
+        }
+        out++;
+    }
+  return simdjson::SUCCESS;
+}
+} // namespace simdjson
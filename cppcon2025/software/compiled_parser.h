@@ -0,0 +1,256 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <meta>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <simdjson.h>
+
+#include "decimal_parse.h"
+#include "key_table.h"
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * A parser generated for one reflected type. The shape of T is known at
+ * compile time, so instead of building a generic tape it walks the bytes,
+ * expecting exactly what T's serializer would write: the members in
+ * declaration order (each key checked with one wide compare, see
+ * key_table.h), integers accumulated straight into the member type,
+ * decimals through decimal_parse.h, strings copied when they have no
+ * escapes.
+ *
+ *   simdjson::compiled_parser<Car> parser;
+ *   Car car;
+ *   auto error = parser.parse(json, car);
+ *
+ * Anything it does not expect (reordered or unknown keys, escapes,
+ * out-of-range numbers, malformed input) sends the document through
+ * the ondemand parser instead, so the result and the errors are those of
+ * doc.get<T>(). UTF-8 is still validated, once for the whole input, up front.
+ *
+ * Supported members: bool, integers, float, double, std::string,
+ * std::vector and std::optional of those, and nested reflected structs.
+ * A compiled_parser is not thread safe, as ondemand::parser is not.
+ */
+namespace simdjson {
+namespace compiled_details {
+
+struct cursor {
+  const char *p;
+  const char *end;
+
+  void skip_whitespace() {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')) { p++; }
+  }
+  bool consume(char c) {
+    skip_whitespace();
+    if (p == end || *p != c) { return false; }
+    p++;
+    return true;
+  }
+  // The literal, followed by something that cannot continue it.
+  bool consume_literal(std::string_view literal) {
+    if (size_t(end - p) < literal.size() || std::memcmp(p, literal.data(), literal.size()) != 0) { return false; }
+    p += literal.size();
+    return p == end || !(decimal_parse::is_digit(*p) || (*p >= 'a' && *p <= 'z'));
+  }
+};
+
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename I>
+bool parse_integer(cursor &c, I &out) {
+  const bool negative = c.p < c.end && *c.p == '-';
+  if (negative) {
+    if constexpr (std::is_unsigned_v<I>) { return false; }
+    c.p++;
+  }
+  const char *start = c.p;
+  uint64_t value = 0;
+  while (c.p < c.end && decimal_parse::is_digit(*c.p) && c.p - start < 19) {
+    value = value * 10 + uint64_t(*c.p - '0');
+    c.p++;
+  }
+  const size_t digits = size_t(c.p - start);
+  if (digits == 0 || (digits > 1 && *start == '0')) { return false; }
+  // More digits, a fraction or an exponent: not an integer we handle here.
+  if (c.p < c.end && (decimal_parse::is_digit(*c.p) || *c.p == '.' || *c.p == 'e' || *c.p == 'E')) { return false; }
+  if (negative) {
+    if (value > uint64_t(std::numeric_limits<I>::max()) + 1) { return false; }
+    out = I(-int64_t(value - 1) - 1);
+  } else {
+    if (value > uint64_t(std::numeric_limits<I>::max())) { return false; }
+    out = I(value);
+  }
+  return true;
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? and nothing else.
+inline bool is_json_number(std::string_view token) {
+  size_t i = 0;
+  auto digits = [&] {
+    const size_t start = i;
+    while (i < token.size() && decimal_parse::is_digit(token[i])) { i++; }
+    return i - start;
+  };
+  if (i < token.size() && token[i] == '-') { i++; }
+  const size_t start = i;
+  const size_t integral = digits();
+  if (integral == 0 || (integral > 1 && token[start] == '0')) { return false; }
+  if (i < token.size() && token[i] == '.') {
+    i++;
+    if (digits() == 0) { return false; }
+  }
+  if (i < token.size() && (token[i] == 'e' || token[i] == 'E')) {
+    i++;
+    if (i < token.size() && (token[i] == '+' || token[i] == '-')) { i++; }
+    if (digits() == 0) { return false; }
+  }
+  return i == token.size();
+}
+
+template <typename F>
+bool parse_floating(cursor &c, F &out) {
+  const char *start = c.p;
+  while (c.p < c.end && (decimal_parse::is_digit(*c.p) || *c.p == '-' || *c.p == '.' || *c.p == 'e' ||
+                         *c.p == 'E' || *c.p == '+')) {
+    c.p++;
+  }
+  const std::string_view token(start, size_t(c.p - start));
+  double value;
+  if (!decimal_parse::parse_short_decimal(token, value)) {
+    // Shortest round-trip output of a float needs up to 17 digits: still a
+    // fast path, through from_chars, once the JSON grammar is checked.
+    if (!is_json_number(token)) { return false; }
+    auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (ec != std::errc() || end != token.data() + token.size()) { return false; }
+  }
+  out = F(value);
+  return true;
+}
+
+inline bool parse_string(cursor &c, std::string &out) {
+  if (c.p == c.end || *c.p != '"') { return false; }
+  const char *start = ++c.p;
+  while (c.p < c.end && *c.p != '"') {
+    // Escapes and control characters are the ondemand parser's business.
+    if (*c.p == '\\' || uint8_t(*c.p) < 0x20) { return false; }
+    c.p++;
+  }
+  if (c.p == c.end) { return false; }
+  out.assign(start, size_t(c.p - start));
+  c.p++;
+  return true;
+}
+
+template <typename T>
+bool parse_value(cursor &c, T &out);
+
+template <typename T>
+bool parse_object(cursor &c, T &out) {
+  using namespace key_table_details;
+  if (!c.consume('{')) { return false; }
+  size_t index = 0;
+  bool ok = true;
+  template for (constexpr auto member : members<T>) {
+    if (ok) {
+      if (index > 0 && !c.consume(',')) { ok = false; }
+      if (ok) {
+        c.skip_whitespace();
+        if (!matches<T>(index, std::string_view(c.p, size_t(c.end - c.p)))) { ok = false; }
+      }
+      if (ok) {
+        c.p += packed<T>[index].length;
+        ok = c.consume(':') && parse_value(c, out.[:member:]);
+      }
+      index++;
+    }
+  }
+  return ok && c.consume('}');
+}
+
+template <typename T>
+bool parse_value(cursor &c, T &out) {
+  c.skip_whitespace();
+  if constexpr (std::is_same_v<T, bool>) {
+    if (c.consume_literal("true")) { out = true; return true; }
+    if (c.consume_literal("false")) { out = false; return true; }
+    return false;
+  } else if constexpr (std::is_integral_v<T>) {
+    return parse_integer(c, out);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return parse_floating(c, out);
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    return parse_string(c, out);
+  } else if constexpr (is_optional<T>::value) {
+    if (c.consume_literal("null")) { out.reset(); return true; }
+    return parse_value(c, out.emplace());
+  } else if constexpr (is_vector<T>::value) {
+    out.clear();
+    if (!c.consume('[')) { return false; }
+    if (c.consume(']')) { return true; }
+    do {
+      typename T::value_type element{};
+      if (!parse_value(c, element)) { return false; }
+      out.push_back(std::move(element));
+    } while (c.consume(','));
+    return c.consume(']');
+  } else {
+    static_assert(std::is_aggregate_v<T>, "compiled_parser only handles the member types listed in compiled_parser.h");
+    return parse_object(c, out);
+  }
+}
+
+} // namespace compiled_details
+
+template <typename T>
+class compiled_parser {
+public:
+  error_code parse(padded_string_view json, T &out) {
+    instrumentation::add(instrumentation::bytes_indexed, json.size());
+    if (!validate_utf8(json.data(), json.size())) { return UTF8_ERROR; }
+    compiled_details::cursor c{json.data(), json.data() + json.size()};
+    if (compiled_details::parse_value(c, out)) {
+      c.skip_whitespace();
+      if (c.p == c.end) {
+        compiled_count++;
+        return SUCCESS;
+      }
+    }
+    fallback_count++;
+    out = T{};
+    ondemand::document doc;
+    auto error = fallback.iterate(json).get(doc);
+    if (error) { return error; }
+    return doc.get(out);
+  }
+
+  // How many documents each path handled.
+  size_t compiled_parses() const { return compiled_count; }
+  size_t fallback_parses() const { return fallback_count; }
+
+private:
+  ondemand::parser fallback;
+  size_t compiled_count{0};
+  size_t fallback_count{0};
+};
+
+} // namespace simdjson
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+/**
+ * Runtime CPU dispatch, generalized from examples/dispatch.cpp.
+ *
+ * Each kernel is compiled for its own instruction set with
+ * __attribute__((target("..."))), whatever the flags of the translation
+ * unit. A dispatched function starts out pointing at a trampoline that
+ * queries the CPU, picks the best kernel and patches the pointer: every
+ * later call is a single indirect call.
+ *
+ *   float (*select_sum())(const float *, size_t) {
+ *     if (cpu_dispatch::supports(cpu_dispatch::avx2)) { return sum_avx2; }
+ *     return sum_generic;
+ *   }
+ *   float sum(const float *data, size_t n) {
+ *     return cpu_dispatch::dispatched<select_sum>::call(data, n);
+ *   }
+ */
+namespace cpu_dispatch {
+
+enum feature : uint32_t {
+  sse2 = 1 << 0,
+  ssse3 = 1 << 1,
+  avx2 = 1 << 2,
+  avx512f = 1 << 3,
+  avx512bw = 1 << 4,
+  neon = 1 << 5,
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+inline uint64_t xgetbv() {
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (uint64_t(edx) << 32) | eax;
+}
+#endif
+
+inline uint32_t detect_features() {
+  uint32_t features = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) { return 0; }
+  if (edx & bit_SSE2) { features |= sse2; }
+  if (ecx & bit_SSSE3) { features |= ssse3; }
+  // The wide registers also need the operating system to save them.
+  const bool os_saves_ymm = (ecx & bit_OSXSAVE) && (xgetbv() & 0x6) == 0x6;
+  const bool os_saves_zmm = os_saves_ymm && (xgetbv() & 0xe0) == 0xe0;
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+    if (os_saves_ymm && (ebx & bit_AVX2)) { features |= avx2; }
+    if (os_saves_zmm && (ebx & bit_AVX512F)) { features |= avx512f; }
+    if (os_saves_zmm && (ebx & bit_AVX512F) && (ebx & bit_AVX512BW)) { features |= avx512bw; }
+  }
+#elif defined(__aarch64__) && defined(__linux__)
+  if (getauxval(AT_HWCAP) & HWCAP_ASIMD) { features |= neon; }
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+  features |= neon; // e.g., Apple Silicon: NEON is always there.
+#endif
+  return features;
+}
+
+// Queried once, thread-safe.
+inline uint32_t features() {
+  static const uint32_t detected = detect_features();
+  return detected;
+}
+
+inline bool supports(uint32_t required) { return (features() & required) == required; }
+
+template <auto Select, typename = decltype(Select())>
+class dispatched;
+
+/**
+ * Select() returns the kernel for this host; it runs at most once. Threads
+ * racing on the first call all wait on the same thread-safe static, then
+ * store the same pointer: there is no torn or half-initialized state.
+ */
+template <auto Select, typename R, typename... Args>
+class dispatched<Select, R (*)(Args...)> {
+public:
+  using function_type = R (*)(Args...);
+
+  static R call(Args... args) { return implementation.load(std::memory_order_acquire)(args...); }
+
+  static function_type resolve() {
+    static const function_type chosen = Select();
+    implementation.store(chosen, std::memory_order_release);
+    return chosen;
+  }
+
+private:
+  static R initialize(Args... args) { return resolve()(args...); }
+
+  static inline std::atomic<function_type> implementation{&initialize};
+};
+
+} // namespace cpu_dispatch
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * A fast path for the short decimals that dominate forecast payloads
+ * ("12.3", "-0.25", "87"). Digits are consumed eight at a time with SWAR
+ * (SIMD within a register) arithmetic. Only numbers of the form
+ * -?[0-9]+(\.[0-9]+)? with at most 15 significant digits are accepted: then
+ * both the mantissa and the power of ten are exact doubles, and a single
+ * division is correctly rounded. Anything else (exponents, long mantissas,
+ * malformed input) returns false and should go through the general parser.
+ */
+namespace decimal_parse {
+
+inline bool is_digit(char c) { return unsigned(c - '0') <= 9; }
+
+inline bool is_eight_digits(const char *p) {
+  uint64_t val;
+  std::memcpy(&val, p, sizeof(val));
+  return (((val & 0xF0F0F0F0F0F0F0F0) |
+           (((val + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+          0x3333333333333333);
+}
+
+// Assumes a little-endian host, see is_eight_digits.
+inline uint32_t parse_eight_digits(const char *p) {
+  uint64_t val;
+  std::memcpy(&val, p, sizeof(val));
+  val = (val & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+  val = (val & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+  return uint32_t((val & 0x0000FFFF0000FFFF) * 42949672960001 >> 32);
+}
+
+inline const char *parse_digits(const char *p, const char *end, uint64_t &mantissa) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  while (end - p >= 8 && is_eight_digits(p)) {
+    mantissa = mantissa * 100000000 + parse_eight_digits(p);
+    p += 8;
+  }
+#endif
+  while (p != end && is_digit(*p)) {
+    mantissa = mantissa * 10 + uint64_t(*p - '0');
+    p++;
+  }
+  return p;
+}
+
+inline bool parse_short_decimal(std::string_view token, double &out) {
+  static constexpr double powers_of_ten[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                             1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+  const char *p = token.data();
+  const char *const end = p + token.size();
+  const bool negative = (p != end && *p == '-');
+  if (negative) { p++; }
+  uint64_t mantissa = 0;
+  const char *const integer_start = p;
+  p = parse_digits(p, end, mantissa);
+  const size_t integer_digits = size_t(p - integer_start);
+  if (integer_digits == 0) { return false; }
+  // JSON does not allow leading zeros.
+  if (*integer_start == '0' && integer_digits > 1) { return false; }
+  size_t fraction_digits = 0;
+  if (p != end && *p == '.') {
+    p++;
+    const char *const fraction_start = p;
+    p = parse_digits(p, end, mantissa);
+    fraction_digits = size_t(p - fraction_start);
+    if (fraction_digits == 0) { return false; }
+  }
+  // Raw tokens may carry the whitespace that follows them.
+  for (; p != end; p++) {
+    if (*p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') { return false; }
+  }
+  if (integer_digits + fraction_digits > 15) { return false; }
+  const double value = double(mantissa) / powers_of_ten[fraction_digits];
+  out = negative ? -value : value;
+  return true;
+}
+
+} // namespace decimal_parse
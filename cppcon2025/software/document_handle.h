@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <simdjson.h>
+
+#include "instrumentation.h"
+#include "padded_buffer.h"
+
+/**
+ * Owns everything a parsed value may point into: the padded input and the
+ * parser (whose string buffer holds unescaped strings). T may then hold
+ * std::string_view members, or custom types such as MyDateView, that refer
+ * to the input without copying. The views are valid as long as the handle
+ * is; moving the handle keeps them valid since both buffers live on the heap.
+ *
+ *   simdjson::document_handle<weather_data_view> forecast(client.release_response(), "/hourly");
+ *   std::string_view first = forecast->time[0].to_string();
+ */
+namespace simdjson {
+template <typename T>
+class document_handle {
+public:
+    explicit document_handle(padded_buffer json, std::string_view json_pointer = "")
+        : input(std::make_unique<padded_buffer>(std::move(json))),
+          parser(std::make_unique<ondemand::parser>()) {
+        instrumentation::add(instrumentation::bytes_indexed, input->size());
+        ondemand::document doc = parser->iterate(input->view());
+        if (json_pointer.empty()) {
+            parsed = doc.get<T>();
+        } else {
+            parsed = doc.at_pointer(json_pointer).get<T>();
+        }
+    }
+    document_handle(document_handle &&) noexcept = default;
+    document_handle& operator=(document_handle &&) noexcept = default;
+
+    const T &operator*() const { return parsed; }
+    const T *operator->() const { return &parsed; }
+
+private:
+    // Declaration order matters: parsed is destroyed before what it views.
+    std::unique_ptr<padded_buffer> input;
+    std::unique_ptr<ondemand::parser> parser;
+    T parsed{};
+};
+} // namespace simdjson
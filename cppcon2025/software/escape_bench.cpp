@@ -0,0 +1,77 @@
+// Micro-benchmark for the fmt-based serialize_player(): SIMD escaping versus
+// the byte-at-a-time loop, with nlohmann's dump() in to_json_string() as the
+// baseline. We check that all three produce the same JSON.
+//
+// Usage: ./escape_bench [players] [escape_per_mille]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include "player.h"
+
+std::string random_text(std::mt19937 &rng, size_t length, unsigned escape_per_mille) {
+  static constexpr std::string_view needs_escaping = "\"\\\n\t\x01";
+  std::string text(length, ' ');
+  for (char &c : text) {
+    if (rng() % 1000 < escape_per_mille) {
+      c = needs_escaping[rng() % needs_escaping.size()];
+    } else {
+      c = char('a' + rng() % 26);
+    }
+  }
+  return text;
+}
+
+template <typename F>
+void bench(const char *name, const std::vector<Player> &players, F serialize) {
+  // Warm up, and measure the output volume.
+  size_t volume = 0;
+  for (const Player &p : players) { volume += serialize(p).size(); }
+  size_t rounds = 0;
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed{};
+  do {
+    for (const Player &p : players) {
+      std::string json = serialize(p);
+      asm volatile("" : : "r"(json.data()) : "memory");
+    }
+    rounds++;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.5);
+  double mb = double(volume) * double(rounds) / 1e6;
+  fmt::print("{:<40} : {:10.2f} MB/s\n", name, mb / elapsed.count());
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 10000;
+  unsigned escape_per_mille = argc > 2 ? unsigned(std::stoul(argv[2])) : 5;
+  std::mt19937 rng(1234);
+  std::vector<Player> players;
+  players.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    Player p{random_text(rng, 4 + rng() % 60, escape_per_mille), int(rng() % 100),
+             double(rng() % 1000) / 10.0, {}};
+    for (size_t j = rng() % 8; j > 0; j--) {
+      p.inventory.push_back(random_text(rng, 4 + rng() % 200, escape_per_mille));
+    }
+    players.push_back(std::move(p));
+  }
+  for (const Player &p : players) {
+    auto expected = nlohmann::json::parse(to_json_string(p));
+    if (nlohmann::json::parse(serialize_player(p)) != expected ||
+        nlohmann::json::parse(serialize_player(p, json_escape::escape_scalar_to)) != expected) {
+      std::cerr << "serialize_player() disagrees with to_json_string()" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  fmt::print("# {} players, {} escapes per thousand bytes\n", count, escape_per_mille);
+  bench("nlohmann dump (to_json_string)", players, [](const Player &p) { return to_json_string(p); });
+  bench("fmt + scalar escaping", players, [](const Player &p) { return serialize_player(p, json_escape::escape_scalar_to); });
+  bench("fmt + SIMD escaping (serialize_player)", players, [](const Player &p) { return serialize_player(p); });
+  return EXIT_SUCCESS;
+}
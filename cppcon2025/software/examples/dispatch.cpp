@@ -1,9 +1,13 @@
 #include <cstdint>
 #include <iostream>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
-// fake
-bool has_sse2() { return true; }
-bool has_avx2() { return false; }
+#include "cpu_dispatch.h"
 
 using SumFunc = float (*)(const float *, size_t);
 
@@ -15,41 +19,88 @@ float sum_generic(const float *data, size_t n) {
   return sum;
 }
 
-float sum_sse2(const float *data, size_t n) {
-  printf("sum_sse2...\n");
-
-  return 1.0; // fake
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) float sum_sse2(const float *data, size_t n) {
+  __m128 acc = _mm_setzero_ps();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm_add_ps(acc, _mm_loadu_ps(data + i));
+  }
+  alignas(16) float lanes[4];
+  _mm_store_ps(lanes, acc);
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sum_generic(data + i, n - i);
 }
 
-float sum_avx2(const float *data, size_t n) {
-  return 1.0; // fake
+__attribute__((target("avx2"))) float sum_avx2(const float *data, size_t n) {
+  // Two accumulators hide the latency of the additions.
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+    acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(data + i + 8));
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+  }
+  __m256 acc = _mm256_add_ps(acc0, acc1);
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+  return _mm_cvtss_f32(half) + sum_generic(data + i, n - i);
 }
 
-SumFunc &get_sum_fnc();
-
-float sum_init(const float *data, size_t n) {
-  SumFunc &sum_impl = get_sum_fnc();
-  if (has_avx2()) {
-    sum_impl = sum_avx2;
-  } else if (has_sse2()) {
-    sum_impl = sum_sse2;
-  } else {
-    sum_impl = sum_generic;
+__attribute__((target("avx512f"))) float sum_avx512(const float *data, size_t n) {
+  __m512 acc = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc = _mm512_add_ps(acc, _mm512_loadu_ps(data + i));
   }
-  return sum_impl(data, n);
+  // Masked load for the tail: no scalar loop needed.
+  __mmask16 tail = __mmask16((1u << (n - i)) - 1);
+  acc = _mm512_add_ps(acc, _mm512_maskz_loadu_ps(tail, data + i));
+  return _mm512_reduce_add_ps(acc);
 }
+#elif defined(__ARM_NEON)
+float sum_neon(const float *data, size_t n) {
+  float32x4_t acc = vdupq_n_f32(0.0f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = vaddq_f32(acc, vld1q_f32(data + i));
+  }
+  return vaddvq_f32(acc) + sum_generic(data + i, n - i);
+}
+#endif
 
-SumFunc &get_sum_fnc() {
-  static SumFunc sum_impl = sum_init;
-  return sum_impl;
+SumFunc select_sum() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (cpu_dispatch::supports(cpu_dispatch::avx512f)) {
+    return sum_avx512;
+  } else if (cpu_dispatch::supports(cpu_dispatch::avx2)) {
+    return sum_avx2;
+  } else if (cpu_dispatch::supports(cpu_dispatch::sse2)) {
+    return sum_sse2;
+  }
+#elif defined(__ARM_NEON)
+  if (cpu_dispatch::supports(cpu_dispatch::neon)) {
+    return sum_neon;
+  }
+#endif
+  return sum_generic;
 }
 
-float sum(const float *data, size_t n) { return get_sum_fnc()(data, n); }
+float sum(const float *data, size_t n) { return cpu_dispatch::dispatched<select_sum>::call(data, n); }
 
 int main() {
+  std::cout << "avx512f: " << cpu_dispatch::supports(cpu_dispatch::avx512f)
+            << " avx2: " << cpu_dispatch::supports(cpu_dispatch::avx2)
+            << " sse2: " << cpu_dispatch::supports(cpu_dispatch::sse2)
+            << " neon: " << cpu_dispatch::supports(cpu_dispatch::neon) << std::endl;
   float data[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
   size_t n = sizeof(data) / sizeof(data[0]);
   float result = sum(data, n);
   std::cout << "sum : " << result << std::endl;
+  std::vector<float> many(1001, 0.5f);
+  std::cout << "sum : " << sum(many.data(), many.size()) << " (expected 500.5)" << std::endl;
   return 0;
-}
\ No newline at end of file
+}
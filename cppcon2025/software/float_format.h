@@ -0,0 +1,227 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <meta>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <simdjson.h>
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+#include "instrumentation.h"
+#include "number_array.h"
+
+/**
+ * Float output for JSON, without printf or locales. Two writers:
+ *
+ *  - write_shortest(): the shortest digits that read back as the same
+ *    float or double (std::to_chars, Ryu-style).
+ *  - write_fixed(): a fixed number of decimals, rounded like printf's
+ *    "%.*f". The value is scaled by 10^digits and rounded to an integer
+ *    once, then written as integer digits with the decimal point
+ *    inserted: no general float formatting. Values too large to scale
+ *    (10^digits times the value reaching 2^52) fall back to
+ *    write_shortest().
+ *
+ * NaN and infinity have no JSON form and are written as null.
+ *
+ * Reflected serialization picks the writer per member. Floating-point
+ * members, and vectors of them, use the shortest form, unless annotated
+ * with a precision:
+ *
+ *   struct weather_data {
+ *     [[=simdjson::precision{1}]] std::vector<float> temperature_2m;
+ *   };
+ *   std::string json = simdjson::to_json_formatted(wd); // [21.4,20.0,...]
+ *
+ * A vector of numbers annotated with simdjson::batched goes through
+ * number_array's batched writer instead (shortest form; a precision wins
+ * over it). Other members go through the builder as usual.
+ */
+namespace float_format {
+
+// Enough for "-1.7976931348623157e+308" and for any write_fixed() output.
+constexpr size_t max_chars = 32;
+
+inline constexpr uint64_t powers_of_ten[] = {1,
+                                             10,
+                                             100,
+                                             1000,
+                                             10000,
+                                             100000,
+                                             1000000,
+                                             10000000,
+                                             100000000,
+                                             1000000000,
+                                             10000000000,
+                                             100000000000,
+                                             1000000000000,
+                                             10000000000000,
+                                             100000000000000,
+                                             1000000000000000};
+
+inline char *write_null(char *p) {
+  std::memcpy(p, "null", 4);
+  return p + 4;
+}
+
+template <typename F>
+char *write_shortest(char *p, F value) {
+  static_assert(std::is_floating_point_v<F>);
+  if (!std::isfinite(value)) { return write_null(p); }
+  return std::to_chars(p, p + max_chars, value).ptr;
+}
+
+template <typename F>
+char *write_fixed(char *p, F value, int digits) {
+  static_assert(std::is_floating_point_v<F>);
+  if (!std::isfinite(value)) { return write_null(p); }
+  if (digits < 0 || digits > 15) { return write_shortest(p, value); }
+  const double scale = double(powers_of_ten[digits]);
+  const double magnitude = std::fabs(double(value));
+  const double product = magnitude * scale;
+  // Below 2^52 the fraction of the product is representable, beyond it we
+  // could no longer round.
+  if (!(product < 4503599627370496.0)) { return write_shortest(p, value); }
+  // Round the exact value, as printf does: the product itself was rounded,
+  // fma gives us the error, which only matters when the fraction is 0.5.
+  const double error = std::fma(magnitude, scale, -product);
+  double whole = std::floor(product);
+  const double fraction = product - whole;
+  if (fraction > 0.5 || (fraction == 0.5 && (error > 0 || (error == 0 && std::fmod(whole, 2.0) != 0)))) {
+    whole += 1;
+  }
+  uint64_t units = uint64_t(whole);
+  // As printf: -0.04 with one decimal is "-0.0", and so is -0.0.
+  if (std::signbit(value)) { *p++ = '-'; }
+  p = std::to_chars(p, p + max_chars, units / powers_of_ten[digits]).ptr;
+  if (digits > 0) {
+    *p++ = '.';
+    units %= powers_of_ten[digits];
+    for (int i = digits - 1; i >= 0; i--) {
+      p[i] = char('0' + units % 10);
+      units /= 10;
+    }
+    p += digits;
+  }
+  return p;
+}
+
+} // namespace float_format
+
+namespace simdjson {
+
+// Annotation: write this floating-point member (or vector of them) with
+// exactly `digits` decimals.
+struct precision {
+  int digits;
+};
+
+namespace float_format_details {
+
+template <typename T>
+inline constexpr auto members = std::define_static_array(
+    std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()));
+
+consteval int precision_of(std::meta::info member) {
+  auto found = std::meta::annotations_of_with_type(member, ^^precision);
+  return found.empty() ? -1 : std::meta::extract<precision>(found[0]).digits;
+}
+
+consteval bool is_batched(std::meta::info member) {
+  return !std::meta::annotations_of_with_type(member, ^^batched).empty();
+}
+
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+// Only structs that carry a precision or batched somewhere need our
+// traversal, the builder handles everything else (std::array included).
+template <typename T>
+consteval bool has_annotations() {
+  if constexpr (!std::is_class_v<T> || !std::is_aggregate_v<T>) {
+    return false;
+  } else {
+    for (auto member : members<T>) {
+      if (precision_of(member) >= 0 || is_batched(member)) { return true; }
+    }
+    return false;
+  }
+}
+
+template <typename F>
+void append_float(builder::string_builder &b, F value, int digits) {
+  instrumentation::add(digits < 0 ? instrumentation::floats_formatted_shortest
+                                  : instrumentation::floats_formatted_fixed);
+  char buffer[float_format::max_chars];
+  char *end = digits < 0 ? float_format::write_shortest(buffer, value)
+                         : float_format::write_fixed(buffer, value, digits);
+  b.append_raw(std::string_view(buffer, size_t(end - buffer)));
+}
+
+template <typename T>
+void append_formatted(builder::string_builder &b, const T &value);
+
+template <int Digits, bool Batched, typename U>
+void append_member(builder::string_builder &b, const U &value) {
+  if constexpr (Batched && Digits < 0 && is_vector<U>::value && std::is_arithmetic_v<typename U::value_type> &&
+                !std::is_same_v<typename U::value_type, bool>) {
+    number_array::append_array(b, value);
+  } else if constexpr (std::is_floating_point_v<U>) {
+    append_float(b, value, Digits);
+  } else if constexpr (is_vector<U>::value && std::is_floating_point_v<typename U::value_type>) {
+    b.append('[');
+    for (size_t i = 0; i < value.size(); i++) {
+      if (i > 0) { b.append(','); }
+      append_float(b, value[i], Digits);
+    }
+    b.append(']');
+  } else if constexpr (has_annotations<U>()) {
+    append_formatted(b, value);
+  } else {
+    b.append(value);
+  }
+}
+
+template <typename T>
+void append_formatted(builder::string_builder &b, const T &value) {
+  b.append('{');
+  template for (constexpr auto member : members<T>) {
+    if constexpr (member != members<T>[0]) { b.append(','); }
+    // Identifiers never need escaping.
+    b.append('"');
+    b.append_raw(std::meta::identifier_of(member));
+    b.append_raw("\":");
+    append_member<precision_of(member), is_batched(member)>(b, value.[:member:]);
+  }
+  b.append('}');
+}
+
+} // namespace float_format_details
+
+template <typename T>
+void append_formatted(builder::string_builder &b, const T &value) {
+  float_format_details::append_formatted(b, value);
+}
+
+template <typename T>
+simdjson_result<std::string> to_json_formatted(const T &value) {
+  builder::string_builder b;
+  append_formatted(b, value);
+  std::string_view json;
+  auto error = b.view().get(json);
+  if (error) { return error; }
+  return std::string(json);
+}
+
+} // namespace simdjson
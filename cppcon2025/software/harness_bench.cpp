@@ -0,0 +1,66 @@
+// The C++ side of the cross-language harness (../harness/run.py): parses
+// twitter.json into the structs of twitter_data.h with simdjson reflection,
+// then serializes them back, and prints one JSON result line per workload.
+// The Go, Java and Rust programs do the same with the same fields.
+//
+// Usage: ./harness_bench twitter.json [warmup] [iterations]
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "mapped_file.h"
+#include "twitter_data.h"
+
+// The schema shared by all languages.
+void report(const char *workload, size_t input_bytes, size_t output_bytes, size_t items, size_t iterations,
+            double seconds, size_t volume) {
+  fmt::print("{{\"language\":\"C++\",\"library\":\"simdjson (reflection)\",\"workload\":\"{}\","
+             "\"input_bytes\":{},\"output_bytes\":{},\"items\":{},\"iterations\":{},\"seconds\":{:.6f},"
+             "\"mb_per_s\":{:.2f}}}\n",
+             workload, input_bytes, output_bytes, items, iterations, seconds,
+             double(volume) * double(iterations) / seconds / 1e6);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fmt::print(stderr, "Usage: {} twitter.json [warmup] [iterations]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  const size_t warmup = argc > 2 ? std::stoul(argv[2]) : 100;
+  const size_t iterations = argc > 3 ? std::stoul(argv[3]) : 1000;
+  simdjson::mapped_file file;
+  if (simdjson::mapped_file::load(argv[1]).get(file)) {
+    fmt::print(stderr, "could not load {}\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  simdjson::ondemand::parser parser;
+  TwitterFeed feed;
+  auto parse = [&] {
+    simdjson::ondemand::document doc;
+    if (parser.iterate(file.view()).get(doc) || doc.get(feed)) { std::abort(); }
+  };
+  std::string out;
+  auto serialize = [&] {
+    if (simdjson::to_json(feed).get(out)) { std::abort(); }
+  };
+  parse();
+  serialize();
+  const size_t output_bytes = out.size();
+
+  using clock = std::chrono::steady_clock;
+  for (size_t i = 0; i < warmup; i++) { parse(); }
+  auto start = clock::now();
+  for (size_t i = 0; i < iterations; i++) { parse(); }
+  double seconds = std::chrono::duration<double>(clock::now() - start).count();
+  report("parse", file.size(), output_bytes, feed.statuses.size(), iterations, seconds, file.size());
+
+  for (size_t i = 0; i < warmup; i++) { serialize(); }
+  start = clock::now();
+  for (size_t i = 0; i < iterations; i++) { serialize(); }
+  seconds = std::chrono::duration<double>(clock::now() - start).count();
+  report("serialize", file.size(), output_bytes, feed.statuses.size(), iterations, seconds, output_bytes);
+  return EXIT_SUCCESS;
+}
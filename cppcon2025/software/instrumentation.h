@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "striped_counter.h"
+
+#ifndef SIMDJSON_INSTRUMENTATION
+#define SIMDJSON_INSTRUMENTATION 0
+#endif
+
+/**
+ * Per-stage event counts of our parse and serialize paths, compiled in
+ * only with -DSIMDJSON_INSTRUMENTATION=1 (the SIMDJSON_INSTRUMENTATION
+ * CMake option). Otherwise add() is an empty inline function, the hooks
+ * vanish, and every count reads as zero.
+ *
+ * Each event is counted twice: for this thread, in plain thread_local
+ * integers, so that a call_scope gives what one call did; and for the
+ * process, in striped counters, for prometheus_text():
+ *
+ *   instrumentation::call_scope scope;
+ *   auto error = doc["hourly"].get(wd);
+ *   uint64_t indexed = scope.elapsed()[instrumentation::bytes_indexed];
+ *
+ *   std::string metrics = instrumentation::prometheus_text(); // for /metrics
+ *
+ * Only the code in this directory is instrumented; what happens inside
+ * simdjson itself (e.g., the growth of its string_builder) is not seen.
+ * For the two calls we set out to look into, that means:
+ *  - doc["hourly"].get<weather_data>(): the keys are matched by
+ *    key_table.h (key_speculation_hits and _misses), the float columns
+ *    parsed by column_deserialize.h (decimals_parsed_fast and _fallback),
+ *    the bytes handed to the parser by weather_client or weather_loop are
+ *    in bytes_indexed, and the growth of their response buffers in
+ *    buffer_growths. Only the time strings are simdjson's, so uncounted;
+ *  - simdjson::to_json(car): nothing, it is simdjson's builder throughout.
+ *    Members annotated with simdjson::batched and serialized with
+ *    to_json_formatted() go through number_array.h, which counts them.
+ */
+namespace instrumentation {
+
+enum counter : size_t {
+  bytes_indexed,          // handed to a parser
+  escape_fast_path,       // strings copied without any escape
+  escape_slow_path,       // strings with at least one escaped byte
+  integers_formatted,
+  floats_formatted_shortest,
+  floats_formatted_fixed,
+  decimals_parsed_fast,   // see column_deserialize.h
+  decimals_parsed_fallback,
+  key_speculation_hits,   // see key_table.h
+  key_speculation_misses,
+  buffer_growths,         // reallocations of our own buffers
+  counter_count
+};
+
+struct description {
+  std::string_view name;
+  std::string_view help;
+};
+
+inline constexpr std::array<description, counter_count> descriptions{{
+    {"bytes_indexed", "Bytes handed to a parser."},
+    {"escape_fast_path", "Strings serialized without any escaped byte."},
+    {"escape_slow_path", "Strings serialized with at least one escaped byte."},
+    {"integers_formatted", "Integers written by the batched array writers."},
+    {"floats_formatted_shortest", "Floating-point numbers written in shortest form."},
+    {"floats_formatted_fixed", "Floating-point numbers written with a fixed precision."},
+    {"decimals_parsed_fast", "Numbers of float columns parsed as short decimals."},
+    {"decimals_parsed_fallback", "Numbers of float columns that needed get_double()."},
+    {"key_speculation_hits", "Object keys found at the speculated position."},
+    {"key_speculation_misses", "Object keys that needed a hash lookup."},
+    {"buffer_growths", "Reallocations of input and output buffers."},
+}};
+
+struct counts {
+  std::array<uint64_t, counter_count> value{};
+
+  uint64_t operator[](counter c) const { return value[c]; }
+  counts operator-(const counts &other) const {
+    counts difference;
+    for (size_t i = 0; i < counter_count; i++) { difference.value[i] = value[i] - other.value[i]; }
+    return difference;
+  }
+};
+
+constexpr bool enabled = SIMDJSON_INSTRUMENTATION;
+
+#if SIMDJSON_INSTRUMENTATION
+namespace details {
+inline striped_counter process[counter_count];
+inline thread_local counts thread;
+} // namespace details
+
+inline void add(counter c, uint64_t n = 1) {
+  details::thread.value[c] += n;
+  details::process[c].add(n);
+}
+
+inline counts this_thread() { return details::thread; }
+
+inline counts totals() {
+  counts result;
+  for (size_t i = 0; i < counter_count; i++) { result.value[i] = details::process[i].total(); }
+  return result;
+}
+
+// Process totals only; per-thread counts are for differences.
+inline void reset() {
+  for (auto &c : details::process) { c.reset(); }
+}
+#else
+inline void add(counter, uint64_t = 1) {}
+inline counts this_thread() { return {}; }
+inline counts totals() { return {}; }
+inline void reset() {}
+#endif
+
+// The events of this thread since construction.
+class call_scope {
+public:
+  counts elapsed() const { return this_thread() - start; }
+
+private:
+  counts start{this_thread()};
+};
+
+// The process totals in the Prometheus text exposition format, one counter
+// per event, e.g., simdjson_bytes_indexed_total.
+inline std::string prometheus_text(std::string_view prefix = "simdjson") {
+  const counts now = totals();
+  std::string out;
+  for (size_t i = 0; i < counter_count; i++) {
+    std::string name(prefix);
+    name += '_';
+    name += descriptions[i].name;
+    name += "_total";
+    out += "# HELP " + name + ' ' + std::string(descriptions[i].help) + '\n';
+    out += "# TYPE " + name + " counter\n";
+    out += name + ' ' + std::to_string(now.value[i]) + '\n';
+  }
+  return out;
+}
+
+} // namespace instrumentation
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "cpu_dispatch.h"
+
+/**
+ * Parses fixed-width "YYYY-MM-DDTHH:MM" timestamps (exactly 16 bytes, as in
+ * the open-meteo time column) into minutes since 1970-01-01T00:00 UTC.
+ * The SSSE3 kernel checks the layout and decodes all twelve digits of a
+ * timestamp at once in one 128-bit register; it is picked at runtime through
+ * cpu_dispatch, other hosts use the scalar kernel. Both reject malformed input and out-of-range fields.
+ */
+namespace iso8601 {
+
+constexpr size_t timestamp_length = 16;
+
+// Howard Hinnant's days_from_civil.
+constexpr int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = unsigned(y - era * 400);
+  const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + int64_t(doe) - 719468;
+}
+
+constexpr bool is_leap_year(unsigned y) {
+  return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+constexpr unsigned days_in_month(unsigned y, unsigned m) {
+  constexpr unsigned days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  return m == 2 && is_leap_year(y) ? 29 : days[m - 1];
+}
+
+inline bool to_epoch_minutes(unsigned year, unsigned month, unsigned day,
+                             unsigned hour, unsigned minute, int64_t &out) {
+  if (month < 1 || month > 12 || day < 1 || day > days_in_month(year, month) ||
+      hour > 23 || minute > 59) {
+    return false;
+  }
+  out = days_from_civil(year, month, day) * 1440 + hour * 60 + minute;
+  return true;
+}
+
+inline bool parse_scalar(const char *p, int64_t &out) {
+  constexpr char layout[] = "0000-00-00T00:00";
+  unsigned digit[timestamp_length];
+  for (size_t i = 0; i < timestamp_length; i++) {
+    if (layout[i] == '0') {
+      digit[i] = unsigned(p[i] - '0');
+      if (digit[i] > 9) { return false; }
+    } else if (p[i] != layout[i]) {
+      return false;
+    }
+  }
+  return to_epoch_minutes(digit[0] * 1000 + digit[1] * 100 + digit[2] * 10 + digit[3],
+                          digit[5] * 10 + digit[6], digit[8] * 10 + digit[9],
+                          digit[11] * 10 + digit[12], digit[14] * 10 + digit[15], out);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("ssse3"))) inline bool parse_ssse3(const char *p, int64_t &out) {
+  const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  // Subtracting the layout maps every expected byte to 0..9 (digits) or to 0
+  // (separators): one unsigned comparison validates the whole timestamp.
+  const __m128i layout = _mm_setr_epi8('0', '0', '0', '0', '-', '0', '0', '-',
+                                       '0', '0', 'T', '0', '0', ':', '0', '0');
+  const __m128i limit = _mm_setr_epi8(9, 9, 9, 9, 0, 9, 9, 0, 9, 9, 0, 9, 9, 0, 9, 9);
+  const __m128i values = _mm_sub_epi8(input, layout);
+  const __m128i in_range = _mm_cmpeq_epi8(_mm_min_epu8(values, limit), values);
+  if (_mm_movemask_epi8(in_range) != 0xFFFF) { return false; }
+  // Gather the digits pairwise, then combine each pair as 10 * hi + lo.
+  const __m128i pairs = _mm_shuffle_epi8(values, _mm_setr_epi8(0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15,
+                                                               -1, -1, -1, -1));
+  const __m128i tens = _mm_maddubs_epi16(pairs, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                                                              10, 1, 0, 0, 0, 0));
+  alignas(16) uint16_t fields[8];
+  _mm_store_si128(reinterpret_cast<__m128i *>(fields), tens);
+  return to_epoch_minutes(fields[0] * 100u + fields[1], fields[2], fields[3], fields[4],
+                          fields[5], out);
+}
+#endif
+
+using parse_function = bool (*)(const char *p, int64_t &out);
+
+inline parse_function select_parse() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (cpu_dispatch::supports(cpu_dispatch::ssse3)) {
+    return parse_ssse3;
+  }
+#endif
+  return parse_scalar;
+}
+
+// p must have at least timestamp_length readable bytes.
+inline bool parse_timestamp(const char *p, int64_t &out) {
+  return cpu_dispatch::dispatched<select_parse>::call(p, out);
+}
+
+} // namespace iso8601
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "cpu_dispatch.h"
+#include "instrumentation.h"
+
+/**
+ * JSON string escaping (the content between the quotes). Blocks of 16, 32 or
+ * 64 bytes, depending on what the host supports at runtime, are checked for
+ * '"', '\\' and control characters at once: clean blocks, by far the common
+ * case, are bulk copied. Only the offending bytes go through the per-byte
+ * path. Bytes >= 0x80 (UTF-8) and DEL are copied as they are.
+ */
+namespace json_escape {
+
+inline void escape_byte(std::string &out, unsigned char c) {
+  switch (c) {
+  case '"': out.append("\\\""); break;
+  case '\\': out.append("\\\\"); break;
+  case '\b': out.append("\\b"); break;
+  case '\f': out.append("\\f"); break;
+  case '\n': out.append("\\n"); break;
+  case '\r': out.append("\\r"); break;
+  case '\t': out.append("\\t"); break;
+  default:
+    if (c < 0x20) {
+      constexpr char hex[] = "0123456789abcdef";
+      const char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+      out.append(escaped, sizeof(escaped));
+    } else {
+      out.push_back(char(c));
+    }
+  }
+}
+
+inline bool needs_escape(unsigned char c) { return c < 0x20 || c == '"' || c == '\\'; }
+
+// The one-byte-at-a-time reference, also used for the tails.
+inline void escape_scalar_to(std::string &out, std::string_view in) {
+  size_t clean_start = 0;
+  for (size_t i = 0; i < in.size(); i++) {
+    if (needs_escape(static_cast<unsigned char>(in[i]))) {
+      out.append(in.data() + clean_start, i - clean_start);
+      escape_byte(out, static_cast<unsigned char>(in[i]));
+      clean_start = i + 1;
+    }
+  }
+  out.append(in.data() + clean_start, in.size() - clean_start);
+}
+
+// Copies the clean prefix of a block, escapes its first offender and
+// returns where to resume.
+inline const char *escape_first(std::string &out, const char *p, int offender) {
+  out.append(p, size_t(offender));
+  escape_byte(out, static_cast<unsigned char>(p[offender]));
+  return p + offender + 1;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) inline void escape_sse2_to(std::string &out, std::string_view in) {
+  out.reserve(out.size() + in.size());
+  const char *p = in.data();
+  const char *const end = p + in.size();
+  while (end - p >= 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v);
+    const __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    const __m128i backslash = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+    const uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_or_si128(control, _mm_or_si128(quote, backslash))));
+    if (mask == 0) {
+      out.append(p, 16);
+      p += 16;
+    } else {
+      p = escape_first(out, p, __builtin_ctz(mask));
+    }
+  }
+  escape_scalar_to(out, std::string_view(p, size_t(end - p)));
+}
+
+__attribute__((target("avx2"))) inline void escape_avx2_to(std::string &out, std::string_view in) {
+  out.reserve(out.size() + in.size());
+  const char *p = in.data();
+  const char *const end = p + in.size();
+  while (end - p >= 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v);
+    const __m256i quote = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+    const __m256i backslash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'));
+    const uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_or_si256(control, _mm256_or_si256(quote, backslash))));
+    if (mask == 0) {
+      out.append(p, 32);
+      p += 32;
+    } else {
+      p = escape_first(out, p, __builtin_ctz(mask));
+    }
+  }
+  escape_scalar_to(out, std::string_view(p, size_t(end - p)));
+}
+
+__attribute__((target("avx512f,avx512bw"))) inline void escape_avx512_to(std::string &out, std::string_view in) {
+  out.reserve(out.size() + in.size());
+  const char *p = in.data();
+  const char *const end = p + in.size();
+  while (end - p >= 64) {
+    const __m512i v = _mm512_loadu_si512(p);
+    const uint64_t mask = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"')) |
+                          _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\')) |
+                          _mm512_cmple_epu8_mask(v, _mm512_set1_epi8(0x1f));
+    if (mask == 0) {
+      out.append(p, 64);
+      p += 64;
+    } else {
+      p = escape_first(out, p, __builtin_ctzll(mask));
+    }
+  }
+  escape_scalar_to(out, std::string_view(p, size_t(end - p)));
+}
+#elif defined(__ARM_NEON)
+inline void escape_neon_to(std::string &out, std::string_view in) {
+  out.reserve(out.size() + in.size());
+  const char *p = in.data();
+  const char *const end = p + in.size();
+  while (end - p >= 16) {
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    const uint8x16_t hits = vorrq_u8(vcleq_u8(v, vdupq_n_u8(0x1f)),
+                                     vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))));
+    // NEON has no movemask: narrowing gives us four bits per byte instead.
+    const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+    if (mask == 0) {
+      out.append(p, 16);
+      p += 16;
+    } else {
+      p = escape_first(out, p, __builtin_ctzll(mask) >> 2);
+    }
+  }
+  escape_scalar_to(out, std::string_view(p, size_t(end - p)));
+}
+#endif
+
+using escape_function = void (*)(std::string &out, std::string_view in);
+
+inline escape_function select_escape() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (cpu_dispatch::supports(cpu_dispatch::avx512bw)) {
+    return escape_avx512_to;
+  } else if (cpu_dispatch::supports(cpu_dispatch::avx2)) {
+    return escape_avx2_to;
+  } else if (cpu_dispatch::supports(cpu_dispatch::sse2)) {
+    return escape_sse2_to;
+  }
+#elif defined(__ARM_NEON)
+  if (cpu_dispatch::supports(cpu_dispatch::neon)) {
+    return escape_neon_to;
+  }
+#endif
+  return escape_scalar_to;
+}
+
+inline void escape_to(std::string &out, std::string_view in) {
+  [[maybe_unused]] const size_t before = out.size();
+  cpu_dispatch::dispatched<select_escape>::call(out, in);
+  if constexpr (instrumentation::enabled) {
+    // Escaping only ever lengthens: same size, nothing was escaped.
+    instrumentation::add(out.size() - before == in.size() ? instrumentation::escape_fast_path
+                                                          : instrumentation::escape_slow_path);
+  }
+}
+
+} // namespace json_escape
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <meta>
+#include <string>
+#include <string_view>
+#include <simdjson.h>
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * Serialization of a value that changes a few members at a time (game
+ * state: health, level...). incremental_json keeps the last serialized form
+ * with the offsets of each member value, and a copy of the value it
+ * describes. Only the members that differ from that copy are serialized
+ * again:
+ *
+ *   simdjson::incremental_json<Player> state(player);
+ *   player.health -= 10;
+ *   state.update(player);                 // rewrites the bytes of "health" only
+ *   std::string_view json = state.json(); // the whole document, up to date
+ *
+ * or, to send only what changed, an RFC 6902 JSON Patch with one replace
+ * per changed member (the form is updated too):
+ *
+ *   std::string patch = state.patch(player);
+ *   // [{"op":"replace","path":"/health","value":89.5}]
+ *
+ * Members are compared with ==, or by their serialized bytes when they have
+ * none; floating-point numbers, and vectors of them, by their bits, so that
+ * 0.0 becoming -0.0 is a change and an unchanged NaN is not. Changes are tracked per top-level member: a change in a nested
+ * struct or a vector replaces the whole member. A value of the same length
+ * is overwritten in place; otherwise the tail of the form moves.
+ */
+namespace simdjson {
+namespace patch_details {
+
+template <typename T>
+inline constexpr auto members = std::define_static_array(
+    std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()));
+
+template <std::meta::info Member>
+consteval auto make_key() {
+  constexpr std::string_view name = std::meta::identifier_of(Member);
+  std::array<char, name.size() + 3> key{};
+  key[0] = '"';
+  for (size_t i = 0; i < name.size(); i++) { key[i + 1] = name[i]; }
+  key[name.size() + 1] = '"';
+  key[name.size() + 2] = ':';
+  return key;
+}
+
+// "name": (identifiers never need escaping).
+template <std::meta::info Member>
+inline constexpr auto key = make_key<Member>();
+
+template <typename U>
+std::string_view serialize(builder::string_builder &b, const U &value) {
+  b.clear();
+  b.append(value);
+  std::string_view json;
+  if (b.view().get(json)) { return {}; }
+  return json;
+}
+
+// Floating-point numbers compare by their bits: == has -0.0 equal to 0.0,
+// which serialize differently, and a NaN never equal to itself.
+template <std::floating_point F>
+bool same_bits(F a, F b) {
+  if constexpr (sizeof(F) == sizeof(uint32_t)) {
+    return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b);
+  } else if constexpr (sizeof(F) == sizeof(uint64_t)) {
+    return std::bit_cast<uint64_t>(a) == std::bit_cast<uint64_t>(b);
+  } else {
+    return a == b && std::signbit(a) == std::signbit(b);
+  }
+}
+
+template <typename U>
+bool same(const U &a, const U &b, builder::string_builder &scratch) {
+  if constexpr (std::floating_point<U>) {
+    return same_bits(a, b);
+  } else if constexpr (requires { requires std::floating_point<typename U::value_type>; a.begin(); a.size(); }) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](auto x, auto y) { return same_bits(x, y); });
+  } else if constexpr (std::equality_comparable<U>) {
+    return a == b;
+  } else {
+    const std::string first(serialize(scratch, a));
+    return first == serialize(scratch, b);
+  }
+}
+
+} // namespace patch_details
+
+template <typename T>
+class incremental_json {
+public:
+  static constexpr size_t member_count = patch_details::members<T>.size();
+
+  explicit incremental_json(const T &value) : last(value) { rebuild(); }
+
+  // The serialized value, as of the last update() or patch().
+  std::string_view json() const { return text; }
+
+  // Brings json() up to date with value. Returns how many members changed.
+  size_t update(const T &value) {
+    return for_each_change(value, [](std::string_view, std::string_view) {});
+  }
+
+  // The JSON Patch from the last state to value ("[]" when nothing changed),
+  // and json() brought up to date.
+  std::string patch(const T &value) {
+    std::string out = "[";
+    for_each_change(value, [&out](std::string_view name, std::string_view json) {
+      if (out.size() > 1) { out += ','; }
+      out += "{\"op\":\"replace\",\"path\":\"/";
+      out += name;
+      out += "\",\"value\":";
+      out += json;
+      out += '}';
+    });
+    out += ']';
+    return out;
+  }
+
+private:
+  void rebuild() {
+    text = "{";
+    size_t index = 0;
+    template for (constexpr auto member : patch_details::members<T>) {
+      if (index > 0) { text += ','; }
+      text.append(patch_details::key<member>.data(), patch_details::key<member>.size());
+      begin[index] = text.size();
+      text += patch_details::serialize(scratch, last.[:member:]);
+      end[index] = text.size();
+      index++;
+    }
+    text += '}';
+  }
+
+  // Calls changed(name, new json) for each member that differs from last,
+  // then splices the new bytes into text and copies the member into last.
+  template <typename F>
+  size_t for_each_change(const T &value, F changed) {
+    size_t count = 0;
+    size_t index = 0;
+    template for (constexpr auto member : patch_details::members<T>) {
+      if (!patch_details::same(last.[:member:], value.[:member:], scratch)) {
+        const std::string_view json = patch_details::serialize(scratch, value.[:member:]);
+        changed(std::meta::identifier_of(member), json);
+        splice(index, json);
+        last.[:member:] = value.[:member:];
+        count++;
+      }
+      index++;
+    }
+    return count;
+  }
+
+  void splice(size_t index, std::string_view json) {
+    const size_t old_size = end[index] - begin[index];
+    text.replace(begin[index], old_size, json);
+    end[index] = begin[index] + json.size();
+    if (json.size() == old_size) { return; }
+    for (size_t i = index + 1; i < member_count; i++) {
+      begin[i] = begin[i] + json.size() - old_size;
+      end[i] = end[i] + json.size() - old_size;
+    }
+  }
+
+  T last;
+  std::string text;
+  // Where each member value starts and ends in text.
+  std::array<size_t, member_count> begin{};
+  std::array<size_t, member_count> end{};
+  builder::string_builder scratch;
+};
+
+} // namespace simdjson
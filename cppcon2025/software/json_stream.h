@@ -0,0 +1,345 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <meta>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include <curl/curl.h>
+#include <simdjson.h>
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+#include "float_format.h"
+
+/**
+ * Serialization that streams: the JSON goes out in fixed-size chunks
+ * (64 KiB by default) while it is being produced, so a multi-megabyte
+ * document never sits in memory as a whole.
+ *
+ * A chunked_sink buffers one chunk and hands it to a flush callback when
+ * it is full. stream_json() walks a reflected value: structs and vectors
+ * are opened and closed by the walk itself, everything else (strings,
+ * numbers, maps...) is serialized by a reused string_builder and copied
+ * into the chunk, so memory stays bounded by the chunk size plus the
+ * largest single leaf. Vectors of leaves go through the builder in blocks.
+ * Members annotated with simdjson::precision or simdjson::batched come
+ * out as to_json_formatted() writes them, so a streamed upload and a
+ * buffered one give the same bytes.
+ *
+ *   simdjson::chunked_sink sink(simdjson::fd_flush(fd));
+ *   simdjson::stream_json(sink, forecast);
+ *   auto error = sink.finish();
+ *
+ * curl_upload feeds the chunks to CURLOPT_READFUNCTION: the serializer runs
+ * on its own thread, a few chunks ahead of the transfer, so sending
+ * overlaps serializing (see weather_client::post_json()).
+ */
+namespace simdjson {
+
+class chunked_sink {
+public:
+    static constexpr size_t default_chunk_size = 64 * 1024;
+    using flush_function = std::function<error_code(std::string_view)>;
+
+    explicit chunked_sink(flush_function flush, size_t chunk_size = default_chunk_size)
+        : flush_to(std::move(flush)), buffer(new char[chunk_size]), capacity(chunk_size) {}
+    chunked_sink(const chunked_sink &) = delete;
+    chunked_sink &operator=(const chunked_sink &) = delete;
+
+    void write(char c) {
+        if (used == capacity) { flush_chunk(); }
+        buffer[used++] = c;
+    }
+
+    void write(std::string_view data) {
+        while (!data.empty()) {
+            if (used == capacity) { flush_chunk(); }
+            const size_t n = std::min(data.size(), capacity - used);
+            std::memcpy(buffer.get() + used, data.data(), n);
+            used += n;
+            data.remove_prefix(n);
+        }
+    }
+
+    // Flushes what is left. The first error of any flush, if there was one.
+    error_code finish() {
+        if (used > 0) { flush_chunk(); }
+        return first_error;
+    }
+
+    error_code error() const { return first_error; }
+
+private:
+    void flush_chunk() {
+        // After an error we keep going, but stop sending.
+        if (!first_error) { first_error = flush_to(std::string_view(buffer.get(), used)); }
+        used = 0;
+    }
+
+    flush_function flush_to;
+    std::unique_ptr<char[]> buffer;
+    size_t capacity;
+    size_t used{0};
+    error_code first_error{SUCCESS};
+};
+
+// Writes every chunk to fd, retrying partial writes.
+inline chunked_sink::flush_function fd_flush(int fd) {
+    return [fd](std::string_view chunk) {
+        while (!chunk.empty()) {
+            ssize_t written = ::write(fd, chunk.data(), chunk.size());
+            if (written < 0) {
+                if (errno == EINTR) { continue; }
+                return IO_ERROR;
+            }
+            chunk.remove_prefix(size_t(written));
+        }
+        return SUCCESS;
+    };
+}
+
+namespace stream_details {
+
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template <typename T>
+struct is_std_array : std::false_type {};
+template <typename T, size_t N>
+struct is_std_array<std::array<T, N>> : std::true_type {};
+
+// Structs are walked member by member; the builder takes everything else.
+template <typename T>
+constexpr bool is_walked_struct = std::is_class_v<T> && std::is_aggregate_v<T> && !is_std_array<T>::value;
+
+template <typename T>
+constexpr bool is_leaf = !is_walked_struct<T> && !is_vector<T>::value;
+
+// Leaves per builder round trip in vectors of leaves.
+constexpr size_t leaf_block = 256;
+
+inline void write_scratch(chunked_sink &sink, builder::string_builder &scratch) {
+    std::string_view piece;
+    if (scratch.view().get(piece) == SUCCESS) { sink.write(piece); }
+}
+
+// A member annotated for to_json_formatted(), written by the same code;
+// vectors of numbers a block at a time.
+template <int Digits, bool Batched, typename T>
+void stream_formatted(chunked_sink &sink, const T &value, builder::string_builder &scratch) {
+    if constexpr (is_vector<T>::value && std::is_arithmetic_v<typename T::value_type> &&
+                  !std::is_same_v<typename T::value_type, bool>) {
+        using number = typename T::value_type;
+        sink.write('[');
+        for (size_t block = 0; block < value.size(); block += leaf_block) {
+            scratch.clear();
+            const size_t end = std::min(value.size(), block + leaf_block);
+            if (block > 0) { scratch.append(','); }
+            if constexpr (Batched && Digits < 0) {
+                number_array::append_list(scratch, std::span<const number>(value.data() + block, end - block));
+            } else {
+                for (size_t i = block; i < end; i++) {
+                    if (i > block) { scratch.append(','); }
+                    float_format_details::append_member<Digits, false>(scratch, value[i]);
+                }
+            }
+            write_scratch(sink, scratch);
+        }
+        sink.write(']');
+    } else {
+        scratch.clear();
+        float_format_details::append_member<Digits, Batched>(scratch, value);
+        write_scratch(sink, scratch);
+    }
+}
+
+template <typename T>
+void stream(chunked_sink &sink, const T &value, builder::string_builder &scratch) {
+    if constexpr (is_walked_struct<T>) {
+        sink.write('{');
+        bool first = true;
+        template for (constexpr auto member : std::define_static_array(
+                          std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()))) {
+            if (!first) { sink.write(','); }
+            first = false;
+            // Identifiers never need escaping.
+            sink.write('"');
+            sink.write(std::meta::identifier_of(member));
+            sink.write("\":");
+            constexpr int digits = float_format_details::precision_of(member);
+            if constexpr (digits >= 0 || float_format_details::is_batched(member)) {
+                stream_formatted<digits, float_format_details::is_batched(member)>(sink, value.[:member:], scratch);
+            } else {
+                stream(sink, value.[:member:], scratch);
+            }
+        }
+        sink.write('}');
+    } else if constexpr (is_vector<T>::value && !is_leaf<typename T::value_type>) {
+        sink.write('[');
+        for (size_t i = 0; i < value.size(); i++) {
+            if (i > 0) { sink.write(','); }
+            stream(sink, value[i], scratch);
+        }
+        sink.write(']');
+    } else if constexpr (is_vector<T>::value) {
+        sink.write('[');
+        for (size_t block = 0; block < value.size(); block += leaf_block) {
+            scratch.clear();
+            const size_t end = std::min(value.size(), block + leaf_block);
+            for (size_t i = block; i < end; i++) {
+                if (i > 0) { scratch.append(','); }
+                scratch.append(value[i]);
+            }
+            std::string_view piece;
+            if (scratch.view().get(piece) == SUCCESS) { sink.write(piece); }
+        }
+        sink.write(']');
+    } else {
+        scratch.clear();
+        scratch.append(value);
+        std::string_view piece;
+        if (scratch.view().get(piece) == SUCCESS) { sink.write(piece); }
+    }
+}
+
+} // namespace stream_details
+
+template <typename T>
+void stream_json(chunked_sink &sink, const T &value) {
+    builder::string_builder scratch;
+    stream_details::stream(sink, value, scratch);
+}
+
+/**
+ * The producer side (flush(), then close()) runs on the serializing thread,
+ * read() is curl's CURLOPT_READFUNCTION. At most max_chunks chunks wait in
+ * between; their buffers are recycled.
+ */
+class curl_upload {
+public:
+    explicit curl_upload(size_t max_chunks = 4) : limit(max_chunks) {}
+    curl_upload(const curl_upload &) = delete;
+    curl_upload &operator=(const curl_upload &) = delete;
+    ~curl_upload() { curl_slist_free_all(headers); }
+
+    // POST with chunked transfer encoding: the size is not known up front.
+    void attach(CURL *curl) {
+        if (!headers) {
+            headers = curl_slist_append(headers, "Content-Type: application/json");
+            headers = curl_slist_append(headers, "Transfer-Encoding: chunked");
+        }
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, &curl_upload::read);
+        curl_easy_setopt(curl, CURLOPT_READDATA, this);
+    }
+
+    // Back to plain GET requests.
+    static void detach(CURL *curl) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, nullptr);
+        curl_easy_setopt(curl, CURLOPT_READDATA, nullptr);
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    }
+
+    chunked_sink::flush_function flush() {
+        return [this](std::string_view chunk) { return push(chunk); };
+    }
+
+    // No more chunks; error aborts the transfer.
+    void close(error_code error = SUCCESS) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            producer_error = error;
+        }
+        changed.notify_all();
+    }
+
+    // From the consumer side, e.g., when curl gave up: unblocks the producer.
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+        }
+        changed.notify_all();
+    }
+
+    // Runs stream_json() into this upload, then close(). Meant for the
+    // producer thread.
+    template <typename T>
+    void produce(const T &value, size_t chunk_size = chunked_sink::default_chunk_size) {
+        chunked_sink sink(flush(), chunk_size);
+        stream_json(sink, value);
+        close(sink.finish());
+    }
+
+private:
+    error_code push(std::string_view chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return cancelled || ready.size() < limit; });
+        if (cancelled) { return IO_ERROR; }
+        std::string buffer;
+        if (!spare.empty()) {
+            buffer = std::move(spare.back());
+            spare.pop_back();
+        }
+        buffer.assign(chunk);
+        ready.push_back(std::move(buffer));
+        lock.unlock();
+        changed.notify_all();
+        return SUCCESS;
+    }
+
+    static size_t read(char *out, size_t size, size_t nitems, void *userdata) {
+        auto *self = static_cast<curl_upload *>(userdata);
+        std::unique_lock<std::mutex> lock(self->mutex);
+        self->changed.wait(lock, [self] { return !self->ready.empty() || self->closed; });
+        if (self->ready.empty()) {
+            return self->producer_error ? CURL_READFUNC_ABORT : 0;
+        }
+        std::string &front = self->ready.front();
+        const size_t n = std::min(size * nitems, front.size() - self->offset);
+        std::memcpy(out, front.data() + self->offset, n);
+        self->offset += n;
+        if (self->offset == front.size()) {
+            self->spare.push_back(std::move(front));
+            self->ready.pop_front();
+            self->offset = 0;
+            lock.unlock();
+            self->changed.notify_all();
+        }
+        return n;
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::string> ready;
+    std::vector<std::string> spare;
+    size_t offset{0}; // into ready.front()
+    size_t limit;
+    bool closed{false};
+    bool cancelled{false};
+    error_code producer_error{SUCCESS};
+    curl_slist *headers{nullptr};
+};
+
+} // namespace simdjson
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <meta>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <simdjson.h>
+
+#include "column_deserialize.h"
+#include "instrumentation.h"
+#include "striped_counter.h"
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * Order-independent deserialization of reflected structs through a perfect
+ * hash of the member names, computed at compile time. Each key of the
+ * object is hashed, looked up in a small table, checked against the one
+ * candidate name and handed to that member's parser: O(1) per key whatever
+ * the order of the keys, where repeated field lookups degrade as keys come
+ * in an unexpected order.
+ *
+ * Opt in per type with a tag_invoke, as for any custom type:
+ *
+ *   namespace simdjson {
+ *   template <typename simdjson_value>
+ *   auto tag_invoke(deserialize_tag, simdjson_value &val, Player &p) {
+ *     return deserialize_with_key_table(val, p);
+ *   }
+ *   }
+ *
+ * Unknown keys are skipped. A missing member is an error (NO_SUCH_FIELD),
+ * except for std::optional members. Members that are float columns
+ * (std::vector<float>, std::vector<double>) go through deserialize_column()
+ * from column_deserialize.h.
+ *
+ * When producers emit keys in declaration order, deserialize_in_order()
+ * is faster still: it speculates that the next key is the next member and
+ * verifies it with a single 16-byte comparison against the quoted name,
+ * packed at compile time. Only a mismatch goes through the hash table.
+ * key_speculation_hits() and key_speculation_misses() count the outcomes
+ * over all threads.
+ */
+namespace simdjson {
+namespace key_table_details {
+
+template <typename T>
+inline constexpr auto members = std::define_static_array(
+    std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()));
+
+// Cheap hash: length, first two bytes and last byte, enough to tell most
+// member names apart. The full hash covers every byte for the others.
+constexpr uint64_t key_hash(std::string_view key, bool full) {
+  uint64_t h = key.size();
+  if (full) {
+    for (char c : key) { h = (h ^ uint8_t(c)) * 0x100000001b3; }
+    return h;
+  }
+  if (!key.empty()) {
+    h |= uint64_t(uint8_t(key[0])) << 8 | uint64_t(uint8_t(key.back())) << 16;
+    if (key.size() > 1) { h |= uint64_t(uint8_t(key[1])) << 24; }
+  }
+  return h;
+}
+
+struct table_shape {
+  bool full;
+  uint64_t seed;
+  unsigned bits;
+};
+
+constexpr size_t slot_of(uint64_t hash, uint64_t seed, unsigned bits) {
+  return size_t((hash * seed) >> (64 - bits));
+}
+
+// The smallest table with at most 50% load.
+consteval unsigned min_bits(size_t n) {
+  unsigned bits = 1;
+  while ((size_t(1) << bits) < 2 * n) { bits++; }
+  return bits;
+}
+
+template <typename T>
+consteval table_shape find_shape() {
+  constexpr unsigned smallest = min_bits(members<T>.size());
+  constexpr unsigned largest = smallest + 3;
+  for (bool full : {false, true}) {
+    for (unsigned bits = smallest; bits <= largest; bits++) {
+      for (uint64_t seed = 0x9e3779b97f4a7c15; seed < 0x9e3779b97f4a7c15 + 2 * 4096; seed += 2) {
+        std::array<bool, size_t(1) << largest> used{};
+        bool collision = false;
+        template for (constexpr auto member : members<T>) {
+          size_t slot = slot_of(key_hash(std::meta::identifier_of(member), full), seed, bits);
+          collision = collision || used[slot];
+          used[slot] = true;
+        }
+        if (!collision) { return {full, seed, bits}; }
+      }
+    }
+  }
+  throw "simdjson::deserialize_with_key_table: no perfect hash for these member names";
+}
+
+template <typename T>
+inline constexpr table_shape shape = find_shape<T>();
+
+constexpr uint8_t empty_slot = 0xff;
+
+template <typename T>
+consteval auto build_slots() {
+  static_assert(members<T>.size() < empty_slot, "too many members for a key table");
+  std::array<uint8_t, size_t(1) << shape<T>.bits> slots{};
+  for (auto &slot : slots) { slot = empty_slot; }
+  uint8_t index = 0;
+  template for (constexpr auto member : members<T>) {
+    slots[slot_of(key_hash(std::meta::identifier_of(member), shape<T>.full), shape<T>.seed, shape<T>.bits)] = index++;
+  }
+  return slots;
+}
+
+template <typename T>
+inline constexpr auto slots = build_slots<T>();
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T, std::meta::info Member>
+error_code parse_member(ondemand::value &value, T &out) {
+  if constexpr (column_details::float_column<typename[:std::meta::type_of(Member):]>) {
+    return deserialize_column(value, out.[:Member:]);
+  } else {
+    return value.get(out.[:Member:]);
+  }
+}
+
+template <typename T, size_t... I>
+consteval auto make_parsers(std::index_sequence<I...>) {
+  return std::array<error_code (*)(ondemand::value &, T &), sizeof...(I)>{&parse_member<T, members<T>[I]>...};
+}
+
+template <typename T, size_t... I>
+consteval auto make_names(std::index_sequence<I...>) {
+  return std::array<std::string_view, sizeof...(I)>{std::meta::identifier_of(members<T>[I])...};
+}
+
+template <typename T, size_t... I>
+consteval auto make_required(std::index_sequence<I...>) {
+  std::bitset<sizeof...(I)> required;
+  ((required[I] = !is_optional<typename[:std::meta::type_of(members<T>[I]):]>::value), ...);
+  return required;
+}
+
+template <typename T>
+inline constexpr auto parsers = make_parsers<T>(std::make_index_sequence<members<T>.size()>());
+template <typename T>
+inline constexpr auto names = make_names<T>(std::make_index_sequence<members<T>.size()>());
+template <typename T>
+inline constexpr auto required = make_required<T>(std::make_index_sequence<members<T>.size()>());
+
+// The member index for key, or empty_slot.
+template <typename T>
+inline uint8_t find(std::string_view key) {
+  const uint8_t index = slots<T>[slot_of(key_hash(key, shape<T>.full), shape<T>.seed, shape<T>.bits)];
+  return index != empty_slot && names<T>[index] == key ? index : empty_slot;
+}
+
+// The quoted names ("username"), little-endian, in two words, with the
+// masks selecting their bytes. Longer names are compared with memcmp.
+constexpr size_t packed_width = 16;
+
+struct packed_key {
+  uint64_t word[2]{};
+  uint64_t mask[2]{};
+  size_t length{0}; // with the quotes
+};
+
+template <typename T, size_t... I>
+consteval auto make_packed(std::index_sequence<I...>) {
+  std::array<packed_key, sizeof...(I)> packed{};
+  for (size_t i = 0; i < sizeof...(I); i++) {
+    const std::string_view name = names<T>[i];
+    packed[i].length = name.size() + 2;
+    for (size_t b = 0; b < packed[i].length && b < packed_width; b++) {
+      const char c = (b == 0 || b == name.size() + 1) ? '"' : name[b - 1];
+      packed[i].word[b / 8] |= uint64_t(uint8_t(c)) << (8 * (b % 8));
+      packed[i].mask[b / 8] |= uint64_t(0xff) << (8 * (b % 8));
+    }
+  }
+  return packed;
+}
+
+template <typename T>
+inline constexpr auto packed = make_packed<T>(std::make_index_sequence<members<T>.size()>());
+
+// raw is the key token, starting at its opening quote, inside padded input:
+// reading packed_width bytes from it is always safe.
+template <typename T>
+inline bool matches(size_t index, std::string_view raw) {
+  const packed_key &expected = packed<T>[index];
+  if (raw.size() < expected.length) { return false; }
+  if constexpr (std::endian::native == std::endian::little) {
+    if (expected.length <= packed_width) {
+      uint64_t word[2];
+      std::memcpy(word, raw.data(), sizeof(word));
+      return ((word[0] ^ expected.word[0]) & expected.mask[0]) == 0 &&
+             ((word[1] ^ expected.word[1]) & expected.mask[1]) == 0;
+    }
+  }
+  const std::string_view name = names<T>[index];
+  return raw[0] == '"' && raw.substr(1, name.size()) == name && raw[name.size() + 1] == '"';
+}
+
+inline striped_counter speculation_hits;
+inline striped_counter speculation_misses;
+
+template <typename simdjson_field>
+error_code key_of(simdjson_field &field, std::string_view &key) {
+  // Member names never need unescaping: the raw key is enough, unless the
+  // producer escaped something.
+  auto error = field.escaped_key().get(key);
+  if (error) { return error; }
+  if (key.find('\\') != std::string_view::npos) {
+    error = field.unescaped_key().get(key);
+  }
+  return error;
+}
+
+} // namespace key_table_details
+
+inline uint64_t key_speculation_hits() { return key_table_details::speculation_hits.total(); }
+inline uint64_t key_speculation_misses() { return key_table_details::speculation_misses.total(); }
+
+template <typename simdjson_value, typename T>
+error_code deserialize_with_key_table(simdjson_value &val, T &out) {
+  using namespace key_table_details;
+  ondemand::object object;
+  auto error = val.get_object().get(object);
+  if (error) { return error; }
+  std::bitset<members<T>.size()> seen;
+  for (auto field : object) {
+    std::string_view key;
+    error = key_of(field, key);
+    if (error) { return error; }
+    const uint8_t index = find<T>(key);
+    if (index == empty_slot) { continue; }
+    ondemand::value value;
+    error = field.value().get(value);
+    if (error) { return error; }
+    error = parsers<T>[index](value, out);
+    if (error) { return error; }
+    seen[index] = true;
+  }
+  if ((required<T> & ~seen).any()) { return NO_SUCH_FIELD; }
+  return SUCCESS;
+}
+
+template <typename simdjson_value, typename T>
+error_code deserialize_in_order(simdjson_value &val, T &out) {
+  using namespace key_table_details;
+  ondemand::object object;
+  auto error = val.get_object().get(object);
+  if (error) { return error; }
+  std::bitset<members<T>.size()> seen;
+  size_t expected = 0;
+  uint64_t hits = 0, misses = 0;
+  for (auto field : object) {
+    std::string_view raw;
+    error = field.key_raw_json_token().get(raw);
+    if (error) { return error; }
+    uint8_t index;
+    if (expected < members<T>.size() && matches<T>(expected, raw)) {
+      index = uint8_t(expected);
+      hits++;
+    } else {
+      misses++;
+      std::string_view key;
+      error = key_of(field, key);
+      if (error) { return error; }
+      index = find<T>(key);
+      if (index == empty_slot) { continue; }
+    }
+    // Keep speculating from wherever the producer actually is.
+    expected = size_t(index) + 1;
+    ondemand::value value;
+    error = field.value().get(value);
+    if (error) { return error; }
+    error = parsers<T>[index](value, out);
+    if (error) { return error; }
+    seen[index] = true;
+  }
+  speculation_hits.add(hits);
+  speculation_misses.add(misses);
+  instrumentation::add(instrumentation::key_speculation_hits, hits);
+  instrumentation::add(instrumentation::key_speculation_misses, misses);
+  if ((required<T> & ~seen).any()) { return NO_SUCH_FIELD; }
+  return SUCCESS;
+}
+
+} // namespace simdjson
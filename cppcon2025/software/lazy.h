@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <meta>
+#include <string_view>
+#include <simdjson.h>
+
+#include "key_table.h"
+#include "projection.h"
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * A reflected struct whose members are parsed on first access, then cached:
+ *
+ *   simdjson::lazy<weather_data> hourly = doc["hourly"].get<simdjson::lazy<weather_data>>();
+ *   const std::vector<float> &t = hourly.get<&weather_data::temperature_2m>();
+ *   const std::vector<float> &rain = hourly.get<"precipitation">(); // by name
+ *
+ * Deserializing a lazy<T> only walks the object: the structural index takes
+ * us over each value, whose bytes are recorded, and nothing is converted or
+ * allocated. get() parses the one member it is asked for, from those
+ * bytes, with a parser of its own. Members that are never read cost a
+ * skip, not a vector.
+ *
+ * The recorded bytes are views: the input must outlive the lazy<T> (a
+ * document_handle, or the client buffer, as for weather_data_view).
+ * A missing member that is not std::optional fails the deserialization up
+ * front with NO_SUCH_FIELD, as eager parsing would. Parse errors in get()
+ * are sticky: the member reads as its default value (whatever was parsed
+ * before the error is dropped) and error() reports the first failure. A
+ * missing std::optional member reads as empty. A lazy<T> can be reused:
+ * each deserialization starts again from default values.
+ */
+namespace simdjson {
+namespace lazy_details {
+
+// A member name as a template argument: get<"temperature_2m">().
+template <size_t N>
+struct name {
+  char text[N]{};
+  consteval name(const char (&s)[N]) { std::copy_n(s, N, text); }
+  constexpr std::string_view view() const { return std::string_view(text, N - 1); }
+};
+
+template <typename T>
+consteval size_t index_of(std::meta::info member) {
+  size_t index = 0;
+  for (auto m : key_table_details::members<T>) {
+    if (m == member) { return index; }
+    index++;
+  }
+  return index;
+}
+
+template <typename T>
+consteval std::meta::info member_named(std::string_view wanted) {
+  for (auto m : key_table_details::members<T>) {
+    if (std::meta::identifier_of(m) == wanted) { return m; }
+  }
+  return std::meta::info{};
+}
+
+} // namespace lazy_details
+
+template <typename T>
+class lazy {
+public:
+  static constexpr size_t member_count = key_table_details::members<T>.size();
+
+  template <auto Member>
+  const auto &get() {
+    constexpr std::meta::info member = projection_details::member_of<T, Member>();
+    static_assert(member != std::meta::info{}, "lazy<T>::get takes a pointer to a non-static data member of T");
+    return materialize<member>();
+  }
+
+  template <lazy_details::name Name>
+  const auto &get() {
+    constexpr std::meta::info member = lazy_details::member_named<T>(Name.view());
+    static_assert(member != std::meta::info{}, "T has no member of that name");
+    return materialize<member>();
+  }
+
+  // Whether the member was in the object.
+  template <auto Member>
+  bool has() const {
+    return !raw[lazy_details::index_of<T>(projection_details::member_of<T, Member>())].empty();
+  }
+
+  error_code error() const { return first_error; }
+
+  // Records where each member value is. Called by get<lazy<T>>().
+  template <typename simdjson_value>
+  error_code index(simdjson_value &val) {
+    using namespace key_table_details;
+    raw = {};
+    parsed.reset();
+    cache = T{};
+    first_error = SUCCESS;
+    ondemand::object object;
+    auto error = val.get_object().get(object);
+    if (error) { return error; }
+    for (auto field : object) {
+      std::string_view key;
+      error = key_of(field, key);
+      if (error) { return error; }
+      const uint8_t slot = find<T>(key);
+      if (slot == empty_slot) { continue; }
+      ondemand::value value;
+      error = field.value().get(value);
+      if (error) { return error; }
+      error = value.raw_json().get(raw[slot]);
+      if (error) { return error; }
+    }
+    // Mandatory members are checked up front, as eager parsing would.
+    for (size_t i = 0; i < member_count; i++) {
+      if (raw[i].empty() && required<T>[i]) { return NO_SUCH_FIELD; }
+    }
+    return SUCCESS;
+  }
+
+private:
+  template <std::meta::info Member>
+  const auto &materialize() {
+    constexpr size_t i = lazy_details::index_of<T>(Member);
+    auto &slot = cache.[:Member:];
+    if (parsed[i] || raw[i].empty()) { return slot; }
+    parsed[i] = true;
+    // The bytes after the value belong to the input: readable, as padding.
+    const padded_string_view json(raw[i].data(), raw[i].size(), raw[i].size() + SIMDJSON_PADDING);
+    if (!parser) { parser = std::make_unique<ondemand::parser>(); }
+    ondemand::document doc;
+    // From scratch: a deserializer may append to what is already there.
+    slot = {};
+    auto error = parser->iterate(json).get(doc);
+    if (!error) { error = doc.get(slot); }
+    if (error) {
+      // Not half a value.
+      slot = {};
+      if (!first_error) { first_error = error; }
+    }
+    return slot;
+  }
+
+  std::array<std::string_view, member_count> raw{};
+  std::bitset<member_count> parsed;
+  T cache{};
+  std::unique_ptr<ondemand::parser> parser;
+  error_code first_error{SUCCESS};
+};
+
+template <typename simdjson_value, typename T>
+error_code tag_invoke(deserialize_tag, simdjson_value &val, lazy<T> &out) {
+  return out.index(val);
+}
+
+} // namespace simdjson
@@ -0,0 +1,92 @@
+// A client that only needs the temperatures of a forecast: parsing the whole
+// "hourly" object into weather_data, against lazy<weather_data> which
+// converts the one column it is asked for.
+//
+// Usage: ./lazy_bench [hours]
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "lazy.h"
+#include "weather_data.h"
+
+// Microseconds per call, repeated for at least half a second.
+template <typename F>
+double time_us(F f) {
+  f(); // warm up
+  size_t rounds = 0;
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed{};
+  do {
+    f();
+    rounds++;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.5);
+  return elapsed.count() * 1e6 / double(rounds);
+}
+
+weather_data random_forecast(size_t hours) {
+  std::mt19937 rng(1234);
+  weather_data wd;
+  for (size_t h = 0; h < hours; h++) {
+    wd.time.push_back(fmt::format("2025-{:02}-{:02}T{:02}:00", h / 720 % 12 + 1, h / 24 % 30 + 1, h % 24));
+    wd.temperature_2m.push_back(float(int(rng() % 400) - 100) / 10.0f);
+    wd.relative_humidity_2m.push_back(float(rng() % 101));
+    wd.winddirection_10m.push_back(float(rng() % 360));
+    wd.precipitation.push_back(float(rng() % 50) / 10.0f);
+    wd.windspeed_10m.push_back(float(rng() % 600) / 10.0f);
+  }
+  return wd;
+}
+
+float mean(const std::vector<float> &values) {
+  double sum = 0;
+  for (float v : values) { sum += v; }
+  return values.empty() ? 0.0f : float(sum / double(values.size()));
+}
+
+int main(int argc, char **argv) {
+  const size_t hours = argc > 1 ? std::stoul(argv[1]) : 8760;
+  const weather_data expected = random_forecast(hours);
+  const simdjson::padded_string json(
+      fmt::format("{{\"latitude\":52.52,\"longitude\":13.41,\"hourly\":{}}}", simdjson::to_json(expected)));
+  simdjson::ondemand::parser parser;
+
+  float eager_mean = 0;
+  const double eager_us = time_us([&] {
+    simdjson::ondemand::document doc;
+    weather_data wd;
+    if (parser.iterate(json).get(doc) || doc["hourly"].get(wd)) { std::abort(); }
+    eager_mean = mean(wd.temperature_2m);
+  });
+  float lazy_mean = 0;
+  const double lazy_us = time_us([&] {
+    simdjson::ondemand::document doc;
+    simdjson::lazy<weather_data> wd;
+    if (parser.iterate(json).get(doc) || doc["hourly"].get(wd)) { std::abort(); }
+    lazy_mean = mean(wd.get<&weather_data::temperature_2m>());
+    if (wd.error()) { std::abort(); }
+  });
+
+  // Every column must read back as the eager parse has it.
+  {
+    simdjson::ondemand::document doc;
+    simdjson::lazy<weather_data> wd;
+    if (parser.iterate(json).get(doc) || doc["hourly"].get(wd)) { std::abort(); }
+    const bool same = wd.get<"time">() == expected.time && wd.get<&weather_data::windspeed_10m>().size() == hours &&
+                      wd.get<"temperature_2m">().size() == hours && !wd.error();
+    if (!same || eager_mean != lazy_mean) {
+      fmt::print(stderr, "lazy<weather_data> differs from weather_data\n");
+      return EXIT_FAILURE;
+    }
+  }
+  fmt::print("{} hours, {} bytes, mean temperature {:.2f}\n", hours, json.size(), lazy_mean);
+  fmt::print("{:<36} {:>10}\n", "hourly, one column read", "us");
+  fmt::print("{:<36} {:>10.1f}\n", "weather_data", eager_us);
+  fmt::print("{:<36} {:>10.1f}\n", "lazy<weather_data>", lazy_us);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+// A leaderboard object, {"player000001":{"points":...,"level":...},...},
+// parsed into and serialized from std::map (simdjson's generic map
+// support) and the hash maps of string_map.h. One key in a hundred needs
+// escaping.
+//
+// Usage: ./map_bench [entries]
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "string_map.h"
+
+struct LeaderboardEntry {
+  int64_t points;
+  int32_t level;
+};
+
+// Milliseconds per call, repeated for at least half a second.
+template <typename F>
+double time_ms(F f) {
+  f(); // warm up
+  size_t rounds = 0;
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed{};
+  do {
+    f();
+    rounds++;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.5);
+  return elapsed.count() * 1e3 / double(rounds);
+}
+
+template <typename Map>
+void bench(const char *name, const simdjson::padded_string &json, size_t entries) {
+  simdjson::ondemand::parser parser;
+  Map map;
+  const double parse_ms = time_ms([&] {
+    simdjson::ondemand::document doc;
+    if (parser.iterate(json).get(doc) || doc.get(map)) { std::abort(); }
+  });
+  if (map.size() != entries) {
+    fmt::print(stderr, "{}: {} entries, expected {}\n", name, map.size(), entries);
+    std::exit(EXIT_FAILURE);
+  }
+  size_t bytes = 0;
+  const double serialize_ms = time_ms([&] {
+    std::string out = simdjson::to_json(map);
+    bytes = out.size();
+  });
+  fmt::print("{:<32} {:>10.2f} {:>10.2f} {:>10}\n", name, parse_ms, serialize_ms, bytes);
+}
+
+int main(int argc, char **argv) {
+  const size_t entries = argc > 1 ? std::stoul(argv[1]) : 100000;
+  std::mt19937 rng(1234);
+  std::string text = "{";
+  for (size_t i = 0; i < entries; i++) {
+    if (i > 0) { text += ','; }
+    const char *quote = i % 100 == 0 ? "\\\"" : "";
+    text += fmt::format("\"player{:06}{}\":{{\"points\":{},\"level\":{}}}", i, quote, rng() % 1000000, rng() % 100);
+  }
+  text += '}';
+  const simdjson::padded_string json(text);
+  fmt::print("{} entries, {} bytes\n", entries, json.size());
+  fmt::print("{:<32} {:>10} {:>10} {:>10}\n", "map", "parse ms", "write ms", "bytes");
+  bench<std::map<std::string, LeaderboardEntry>>("std::map<std::string, T>", json, entries);
+  bench<simdjson::string_map<LeaderboardEntry>>("simdjson::string_map<T>", json, entries);
+  // The keys view json and the parser: both outlive the map here.
+  bench<simdjson::string_view_map<LeaderboardEntry>>("simdjson::string_view_map<T>", json, entries);
+#if defined(__cpp_lib_flat_map)
+  bench<simdjson::string_flat_map<LeaderboardEntry>>("simdjson::string_flat_map<T>", json, entries);
+#endif
+  return EXIT_SUCCESS;
+}
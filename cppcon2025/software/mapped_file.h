@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <simdjson.h>
+
+/**
+ * A read-only file mapping that simdjson can parse in place. We first
+ * reserve an anonymous, zero-filled region of the file size plus
+ * SIMDJSON_PADDING, then map the file over its start: the bytes after the
+ * end of the file are zeros, from the last page of the file and from the
+ * anonymous pages behind it. The padding comes for free, nothing is copied
+ * and the page cache is shared, so a multi-GB dump costs no extra RSS.
+ *
+ *   simdjson::mapped_file file;
+ *   auto error = simdjson::mapped_file::load("twitter.json").get(file);
+ *   if (!error) { auto doc = parser.iterate(file.view()); }
+ *
+ * Mappings of at least 2 MiB are aligned on 2 MiB and advised to use
+ * transparent huge pages; huge_pages_advised() says whether madvise()
+ * accepted the advice, not whether the kernel then used huge pages (see
+ * FilePmdMapped in /proc/self/smaps; file-backed huge pages need tmpfs or
+ * CONFIG_READ_ONLY_THP_FOR_FS).
+ * With populate, every page is faulted in by load(), after that advice,
+ * rather than during parsing. The file must not shrink while it is mapped (SIGBUS).
+ */
+namespace simdjson {
+
+class mapped_file {
+public:
+    static constexpr size_t huge_page_size = size_t(2) << 20;
+
+    mapped_file() = default;
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+    mapped_file(mapped_file &&other) noexcept { swap(other); }
+    mapped_file &operator=(mapped_file &&other) noexcept {
+        mapped_file(std::move(other)).swap(*this);
+        return *this;
+    }
+    ~mapped_file() {
+        if (region) { munmap(region, region_size); }
+    }
+
+    static simdjson_result<mapped_file> load(std::string_view path, bool populate = false) {
+        const std::string name(path);
+        const int fd = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) { return IO_ERROR; }
+        mapped_file file;
+        const error_code error = file.map(fd, populate);
+        ::close(fd);
+        if (error) { return error; }
+        return file;
+    }
+
+    const char *data() const { return region; }
+    size_t size() const { return length; }
+    bool huge_pages_advised() const { return advised; }
+
+    padded_string_view view() const { return padded_string_view(region, length, length + SIMDJSON_PADDING); }
+
+private:
+    error_code map(int fd, bool populate) {
+        struct stat info;
+        if (fstat(fd, &info) != 0) { return IO_ERROR; }
+        length = size_t(info.st_size);
+        const size_t page = size_t(sysconf(_SC_PAGESIZE));
+        const bool large = length >= huge_page_size;
+        const size_t alignment = large ? huge_page_size : page;
+        const size_t wanted = (length + SIMDJSON_PADDING + alignment - 1) / alignment * alignment;
+        // Over-reserve by the alignment, then trim both ends.
+        const size_t reserved = wanted + (large ? huge_page_size : 0);
+        void *reservation = mmap(nullptr, reserved, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (reservation == MAP_FAILED) { return MEMALLOC; }
+        const uintptr_t start = uintptr_t(reservation);
+        const uintptr_t aligned = (start + alignment - 1) / alignment * alignment;
+        if (aligned > start) { munmap(reservation, aligned - start); }
+        if (start + reserved > aligned + wanted) { munmap(reinterpret_cast<void *>(aligned + wanted), start + reserved - aligned - wanted); }
+        region = reinterpret_cast<char *>(aligned);
+        region_size = wanted;
+        if (length == 0) { return SUCCESS; }
+        if (mmap(region, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) { return IO_ERROR; }
+#ifdef MADV_HUGEPAGE
+        // Before any page is touched, so that the faults can use huge pages.
+        if (large) { advised = madvise(region, length, MADV_HUGEPAGE) == 0; }
+#endif
+        if (populate) {
+#ifdef MADV_POPULATE_READ
+            if (madvise(region, length, MADV_POPULATE_READ) == 0) { return SUCCESS; }
+#endif
+            // Older kernels: touch every page ourselves.
+            for (size_t offset = 0; offset < length; offset += page) {
+                (void)*static_cast<volatile const char *>(region + offset);
+            }
+        }
+        return SUCCESS;
+    }
+
+    void swap(mapped_file &other) noexcept {
+        std::swap(region, other.region);
+        std::swap(region_size, other.region_size);
+        std::swap(length, other.length);
+        std::swap(advised, other.advised);
+    }
+
+    char *region{nullptr};
+    size_t region_size{0};
+    size_t length{0};
+    bool advised{false};
+};
+
+} // namespace simdjson
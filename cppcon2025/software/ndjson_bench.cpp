@@ -0,0 +1,143 @@
+// Bulk loading of newline-delimited Player records: nlohmann's
+// from_json_string() line by line versus the reflection-based ndjson_loader
+// for 1..N threads, with the stage 1 / stage 2 split of the loader. Then,
+// on records whose keys are not in declaration order, reflection's default
+// lookup versus the compile-time key table (HashedPlayer) and the
+// expected-order fast path (OrderedPlayer), in both key orders, with the
+// speculation hit rate of the latter.
+//
+// Usage: ./ndjson_bench [players] [max_threads]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "key_table.h"
+#include "ndjson_loader.h"
+#include "player.h"
+#include "thread_pool.h"
+
+// Same members as Player, deserialized through simdjson's key table.
+struct HashedPlayer {
+  std::string username;
+  int level;
+  double health;
+  std::vector<std::string> inventory;
+};
+
+namespace simdjson {
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, HashedPlayer &p) {
+  return deserialize_with_key_table(val, p);
+}
+} // namespace simdjson
+
+// Same members again, deserialized speculating on declaration order.
+struct OrderedPlayer {
+  std::string username;
+  int level;
+  double health;
+  std::vector<std::string> inventory;
+};
+
+namespace simdjson {
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, OrderedPlayer &p) {
+  return deserialize_in_order(val, p);
+}
+} // namespace simdjson
+
+// With reordered_keys, the records come from nlohmann (keys sorted
+// alphabetically: health, inventory, level, username).
+std::string random_ndjson(size_t count, bool reordered_keys = false) {
+  std::mt19937 rng(1234);
+  auto text = [&rng](size_t length) {
+    std::string s(length, ' ');
+    for (char &c : s) { c = char('a' + rng() % 26); }
+    return s;
+  };
+  std::string ndjson;
+  for (size_t i = 0; i < count; i++) {
+    Player p{text(4 + rng() % 16), int(rng() % 100), double(rng() % 1000) / 10.0, {}};
+    for (size_t j = rng() % 6; j > 0; j--) { p.inventory.push_back(text(4 + rng() % 12)); }
+    ndjson += reordered_keys ? to_json_string(p) : serialize_player(p);
+    ndjson += '\n';
+  }
+  return ndjson;
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  size_t max_threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+  simdjson::padded_string ndjson(random_ndjson(count));
+  const double mb = double(ndjson.size()) / 1e6;
+  fmt::print("# {} players, {:.1f} MB\n", count, mb);
+
+  {
+    std::vector<Player> players;
+    players.reserve(count);
+    auto start = std::chrono::steady_clock::now();
+    std::string_view input(ndjson.data(), ndjson.size());
+    for (size_t line_start = 0; line_start < input.size();) {
+      size_t line_end = input.find('\n', line_start);
+      if (line_end == std::string_view::npos) { line_end = input.size(); }
+      players.push_back(from_json_string(std::string(input.substr(line_start, line_end - line_start))));
+      line_start = line_end + 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fmt::print("{:<36} : {:10.2f} MB/s\n", "nlohmann from_json_string", mb / seconds);
+  }
+
+  fmt::print("{:>8} {:>12} {:>14} {:>14}\n", "threads", "MB/s", "stage 1 (%)", "stage 2 (%)");
+  for (size_t threads = 1; threads <= max_threads; threads++) {
+    thread_pool pool(threads);
+    ndjson_loader<Player> loader(pool);
+    std::vector<Player> players;
+    if (loader.load(ndjson, players)) { return EXIT_FAILURE; } // warm up
+    if (players.size() != count) { return EXIT_FAILURE; }
+    double best = 1e300;
+    for (int round = 0; round < 5; round++) {
+      auto start = std::chrono::steady_clock::now();
+      (void)loader.load(ndjson, players);
+      best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    // A separate timed run: the clock reads slow the loader down.
+    ndjson_loader<Player>::timings time;
+    (void)loader.load(ndjson, players, &time);
+    const double total = time.stage1_seconds + time.stage2_seconds;
+    fmt::print("{:>8} {:>12.2f} {:>14.1f} {:>14.1f}\n", threads, mb / best,
+               100 * time.stage1_seconds / total, 100 * time.stage2_seconds / total);
+  }
+
+  simdjson::padded_string reordered(random_ndjson(count, true));
+  thread_pool pool(1);
+  auto time_load = [&](auto loader, const simdjson::padded_string &input) {
+    std::vector<typename decltype(loader)::value_type> records;
+    double best = 1e300;
+    for (int round = 0; round < 5; round++) {
+      auto start = std::chrono::steady_clock::now();
+      if (loader.load(input, records)) { std::abort(); }
+      best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return double(input.size()) / 1e6 / best;
+  };
+  for (const auto *input : {&ndjson, &reordered}) {
+    fmt::print("# {} keys, one thread\n", input == &ndjson ? "declaration-order" : "reordered");
+    fmt::print("{:<36} : {:10.2f} MB/s\n", "Player (default lookup)", time_load(ndjson_loader<Player>(pool), *input));
+    fmt::print("{:<36} : {:10.2f} MB/s\n", "HashedPlayer (key table)", time_load(ndjson_loader<HashedPlayer>(pool), *input));
+    const uint64_t hits = simdjson::key_speculation_hits(), misses = simdjson::key_speculation_misses();
+    const double rate = time_load(ndjson_loader<OrderedPlayer>(pool), *input);
+    const uint64_t new_hits = simdjson::key_speculation_hits() - hits;
+    const uint64_t new_misses = simdjson::key_speculation_misses() - misses;
+    fmt::print("{:<36} : {:10.2f} MB/s ({:.1f}% speculation hits)\n", "OrderedPlayer (expected order)", rate,
+               100.0 * double(new_hits) / double(std::max<uint64_t>(1, new_hits + new_misses)));
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <simdjson.h>
+
+#include "instrumentation.h"
+#include "thread_pool.h"
+
+/**
+ * Parallel loader for newline-delimited records of a reflected type. The
+ * input is cut at line boundaries into one range per worker thread; every
+ * range is parsed with its own parser through iterate_many (a
+ * document_stream). Lines are counted first, so that the output vector is
+ * sized once and every thread writes its records straight into their final
+ * slots: the result is in input order without any merge.
+ *
+ *   ndjson_loader<Player> loader(pool);
+ *   std::vector<Player> players;
+ *   auto error = loader.load(simdjson::padded_string_view(json), players);
+ *
+ * With timings enabled, load() also splits the time between stage 1
+ * (advancing the document_stream, which indexes each batch) and stage 2
+ * (materializing the records), summed over the threads.
+ */
+template <typename T>
+class ndjson_loader {
+public:
+    using value_type = T;
+
+    struct timings {
+        double stage1_seconds{0};
+        double stage2_seconds{0};
+    };
+
+    explicit ndjson_loader(thread_pool &workers, size_t batch_size = simdjson::dom::DEFAULT_BATCH_SIZE)
+        : pool(workers), batch_size(batch_size) {}
+
+    // The input must stay valid, with its padding, for the whole call.
+    simdjson::error_code load(simdjson::padded_string_view input, std::vector<T> &out, timings *time = nullptr) {
+        const size_t range_count = std::max<size_t>(1, pool.size());
+        while (parsers.size() < range_count) {
+            parsers.push_back(std::make_unique<simdjson::ondemand::parser>());
+        }
+        std::vector<range> ranges = split(input, range_count);
+        size_t total = 0;
+        for (range &r : ranges) {
+            r.first_slot = total;
+            total += r.lines;
+        }
+        out.clear();
+        out.resize(total);
+        pool.parallel_for(ranges.size(), [&](size_t i) {
+            parse_range(input.data(), ranges[i], *parsers[i], out, time != nullptr);
+        });
+        // Blank lines were counted but hold no record: close the gaps, in order.
+        size_t kept = 0;
+        for (const range &r : ranges) {
+            if (r.error) { return r.error; }
+            if (kept != r.first_slot) {
+                std::move(out.begin() + r.first_slot, out.begin() + r.first_slot + r.parsed, out.begin() + kept);
+            }
+            kept += r.parsed;
+        }
+        out.resize(kept);
+        if (time) {
+            *time = {};
+            for (const range &r : ranges) {
+                time->stage1_seconds += r.stage1_seconds;
+                time->stage2_seconds += r.stage2_seconds;
+            }
+        }
+        return simdjson::SUCCESS;
+    }
+
+private:
+    struct range {
+        size_t begin{0};
+        size_t end{0};
+        size_t lines{0};
+        size_t first_slot{0};
+        size_t parsed{0};
+        simdjson::error_code error{simdjson::SUCCESS};
+        double stage1_seconds{0};
+        double stage2_seconds{0};
+    };
+
+    static size_t count_lines(const char *p, const char *end) {
+        size_t lines = 0;
+        const char *line = p;
+        while (line < end) {
+            const char *newline = static_cast<const char *>(std::memchr(line, '\n', size_t(end - line)));
+            lines++;
+            if (!newline) { break; }
+            line = newline + 1;
+        }
+        return lines;
+    }
+
+    static std::vector<range> split(std::string_view input, size_t count) {
+        std::vector<range> ranges;
+        size_t begin = 0;
+        for (size_t i = 1; i <= count && begin < input.size(); i++) {
+            size_t end = input.size() * i / count;
+            if (i < count) {
+                end = input.find('\n', std::max(end, begin));
+                end = end == std::string_view::npos ? input.size() : end + 1;
+            } else {
+                end = input.size();
+            }
+            range r;
+            r.begin = begin;
+            r.end = end;
+            r.lines = count_lines(input.data() + begin, input.data() + end);
+            ranges.push_back(r);
+            begin = end;
+        }
+        return ranges;
+    }
+
+    // The bytes past a range belong to the next range or to the padding:
+    // either way they are readable, as iterate_many requires.
+    void parse_range(const char *data, range &r, simdjson::ondemand::parser &parser, std::vector<T> &out, bool timed) {
+        using clock = std::chrono::steady_clock;
+        simdjson::ondemand::document_stream stream;
+        instrumentation::add(instrumentation::bytes_indexed, r.end - r.begin);
+        r.error = parser.iterate_many(data + r.begin, r.end - r.begin, batch_size).get(stream);
+        if (r.error) { return; }
+        T *slot = out.data() + r.first_slot;
+        auto last = clock::now();
+        for (auto doc : stream) {
+            if (r.parsed == r.lines) { r.error = simdjson::CAPACITY; return; }
+            auto materialize_start = timed ? clock::now() : last;
+            simdjson::ondemand::document_reference record;
+            r.error = std::move(doc).get(record);
+            if (r.error) { return; }
+            r.error = record.template get<T>().get(slot[r.parsed]);
+            if (r.error) { return; }
+            if (timed) {
+                auto now = clock::now();
+                r.stage1_seconds += std::chrono::duration<double>(materialize_start - last).count();
+                r.stage2_seconds += std::chrono::duration<double>(now - materialize_start).count();
+                last = now;
+            }
+            r.parsed++;
+        }
+        if (stream.truncated_bytes() > 0) { r.error = simdjson::TAPE_ERROR; }
+    }
+
+    thread_pool &pool;
+    size_t batch_size;
+    std::vector<std::unique_ptr<simdjson::ondemand::parser>> parsers;
+};
@@ -0,0 +1,664 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <simdjson.h>
+
+#include "cpu_dispatch.h"
+#include "instrumentation.h"
+
+/**
+ * Batched JSON arrays of numbers: "[12,-3,457]" written in one pass, with
+ * the separators, instead of one number at a time. For int32 the digits of
+ * 4, 8 or 16 values (SSE2, AVX2, AVX-512BW; 4 with NEON) are computed at
+ * once: each absolute value below 10^8 is split into two 4-digit halves,
+ * and both halves are broken into digits with multiply-high by reciprocals
+ * of 10 in 16-bit lanes. Every value then comes out as 8 zero-padded digits,
+ * which we copy past their leading zeros. Blocks holding a larger value go
+ * through the scalar path, like the tail.
+ *
+ * Floats are written in their shortest round-trip form, as std::to_chars
+ * writes them, 8 or 16 at a time (AVX2, AVX-512; 4 with NEON). Most floats
+ * in our data are short decimals (21.4, 1013.25): for all lanes at once we
+ * try 0, 1, ... 7 decimals, rounding value * 10^k to the nearest integer n
+ * (ties to even, as to_chars breaks them), and keep the first k for which
+ * n / 10^k lies strictly inside the interval of reals that round to the
+ * float. In double precision these products are exact. That is the
+ * shortest form, and between 10^-3 and 10^5 to_chars writes it in fixed
+ * notation, so we only have to print n with a decimal point. A block
+ * holding anything else (more digits, other magnitudes, NaN) goes through
+ * std::to_chars, like the tail.
+ *
+ * Doubles are not batched: their 53-bit significands times 10^k are no
+ * longer exact in a double, the same check would need 128-bit products.
+ * They, and the other integer types, go through std::to_chars one value at
+ * a time, still in a single pass. NaN and infinity have no JSON form: they
+ * become null.
+ *
+ * The kernels write "v," for each value through a char pointer, with room
+ * for the widest value: append_array() sizes a std::string once and drops
+ * the last comma; its string_builder overload, which cannot write into the
+ * builder in place, goes through a stack buffer one block of values at a
+ * time. Reflected serialization opts in per member, with an annotation:
+ *
+ *   struct Car {
+ *     ...
+ *     [[=simdjson::batched{}]] std::vector<float> tire_pressure;
+ *   };
+ *   std::string json = simdjson::to_json_formatted(car);
+ *
+ * Unannotated vectors go through simdjson's builder as usual.
+ */
+namespace number_array {
+
+// Worst case per int32: "-2147483648,".
+constexpr size_t max_int32_chars = 12;
+
+inline char *write_int32(char *p, int32_t value) {
+  static constexpr char pairs[201] = "00010203040506070809"
+                                     "10111213141516171819"
+                                     "20212223242526272829"
+                                     "30313233343536373839"
+                                     "40414243444546474849"
+                                     "50515253545556575859"
+                                     "60616263646566676869"
+                                     "70717273747576777879"
+                                     "80818283848586878889"
+                                     "90919293949596979899";
+  uint32_t v = uint32_t(value);
+  if (value < 0) {
+    *p++ = '-';
+    v = 0u - v;
+  }
+  char buffer[10];
+  char *end = buffer + sizeof(buffer);
+  char *q = end;
+  while (v >= 100) {
+    q -= 2;
+    std::memcpy(q, pairs + 2 * (v % 100), 2);
+    v /= 100;
+  }
+  if (v >= 10) {
+    q -= 2;
+    std::memcpy(q, pairs + 2 * v, 2);
+  } else {
+    *--q = char('0' + v);
+  }
+  std::memcpy(p, q, size_t(end - q));
+  return p + (end - q);
+}
+
+// digits holds 8 ASCII digits, zero padded; we need 16 readable bytes.
+inline char *write_eight_digits(char *p, const char *digits, bool negative) {
+  uint64_t word;
+  std::memcpy(&word, digits, sizeof(word));
+  // Leading '0' bytes, keeping at least one digit. Assumes little endian.
+  const uint64_t nonzero = word ^ 0x3030303030303030;
+  const size_t zeros = nonzero == 0 ? 7 : size_t(__builtin_ctzll(nonzero)) / 8;
+  *p = '-';
+  p += negative;
+  std::memcpy(p, digits + zeros, 8);
+  return p + (8 - zeros);
+}
+
+// Leaves room for max_int32_chars per value, and the brackets. Kernels
+// write each value followed by ',', end_array() replaces the last one.
+inline char *begin_array(std::string &out, size_t count, size_t width = max_int32_chars) {
+  const size_t start = out.size();
+  out.resize(start + 2 + count * width + 16);
+  char *p = out.data() + start;
+  *p++ = '[';
+  return p;
+}
+
+inline void end_array(std::string &out, char *p, size_t count) {
+  if (count > 0) { p--; }
+  *p++ = ']';
+  out.resize(size_t(p - out.data()));
+}
+
+inline char *write_int32_list(char *p, std::span<const int32_t> values) {
+  for (int32_t v : values) {
+    p = write_int32(p, v);
+    *p++ = ',';
+  }
+  return p;
+}
+
+inline void append_int32_scalar(std::string &out, std::span<const int32_t> values) {
+  end_array(out, write_int32_list(begin_array(out, values.size()), values), values.size());
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// y / 10 for y < 43699, in 16-bit lanes.
+__attribute__((target("sse2"))) inline __m128i div10_sse2(__m128i y) {
+  return _mm_srli_epi16(_mm_mulhi_epu16(y, _mm_set1_epi16(int16_t(52429))), 3);
+}
+__attribute__((target("avx2"))) inline __m256i div10_avx2(__m256i y) {
+  return _mm256_srli_epi16(_mm256_mulhi_epu16(y, _mm256_set1_epi16(int16_t(52429))), 3);
+}
+__attribute__((target("avx512f,avx512bw"))) inline __m512i div10_avx512(__m512i y) {
+  return _mm512_srli_epi16(_mm512_mulhi_epu16(y, _mm512_set1_epi16(int16_t(52429))), 3);
+}
+
+// Four absolute values below 10^8 to 4 x 8 digits, as 2 x 16 bytes.
+__attribute__((target("sse2"))) inline void eight_digits_sse2(__m128i v, __m128i &first, __m128i &second) {
+  const __m128i magic = _mm_set1_epi32(int(0xd1b71759)); // / 10000, with >> 45
+  const __m128i even = _mm_srli_epi64(_mm_mul_epu32(v, magic), 45);
+  const __m128i odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(v, 32), magic), 45);
+  const __m128i high = _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+  const __m128i low = _mm_sub_epi32(v, _mm_madd_epi16(high, _mm_set1_epi32(10000)));
+  // 16-bit lanes: high0, low0, high1, low1, ...
+  const __m128i x = _mm_or_si128(high, _mm_slli_epi32(low, 16));
+  const __m128i ten = _mm_set1_epi16(10);
+  const __m128i t1 = div10_sse2(x), t2 = div10_sse2(t1), a = div10_sse2(t2);
+  const __m128i d = _mm_sub_epi16(x, _mm_mullo_epi16(t1, ten));
+  const __m128i c = _mm_sub_epi16(t1, _mm_mullo_epi16(t2, ten));
+  const __m128i b = _mm_sub_epi16(t2, _mm_mullo_epi16(a, ten));
+  const __m128i ab = _mm_or_si128(a, _mm_slli_epi16(b, 8));
+  const __m128i cd = _mm_or_si128(c, _mm_slli_epi16(d, 8));
+  const __m128i zero = _mm_set1_epi8('0');
+  first = _mm_add_epi8(_mm_unpacklo_epi16(ab, cd), zero);
+  second = _mm_add_epi8(_mm_unpackhi_epi16(ab, cd), zero);
+}
+
+__attribute__((target("sse2"))) inline char *write_int32_list_sse2(char *p, std::span<const int32_t> values) {
+  alignas(16) char digits[4 * 8 + 16];
+  size_t i = 0;
+  for (; i + 4 <= values.size(); i += 4) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values.data() + i));
+    const __m128i sign = _mm_srai_epi32(v, 31);
+    const __m128i magnitude = _mm_sub_epi32(_mm_xor_si128(v, sign), sign);
+    // INT32_MIN stays negative: it fails the test too.
+    const __m128i large = _mm_or_si128(_mm_cmpgt_epi32(magnitude, _mm_set1_epi32(99999999)),
+                                       _mm_cmplt_epi32(magnitude, _mm_setzero_si128()));
+    if (_mm_movemask_epi8(large) != 0) {
+      p = write_int32_list(p, values.subspan(i, 4));
+      continue;
+    }
+    __m128i first, second;
+    eight_digits_sse2(magnitude, first, second);
+    _mm_store_si128(reinterpret_cast<__m128i *>(digits), first);
+    _mm_store_si128(reinterpret_cast<__m128i *>(digits + 16), second);
+    const int negative = _mm_movemask_ps(_mm_castsi128_ps(v));
+    for (size_t k = 0; k < 4; k++) {
+      p = write_eight_digits(p, digits + 8 * k, (negative >> k) & 1);
+      *p++ = ',';
+    }
+  }
+  return write_int32_list(p, values.subspan(i));
+}
+
+// The same steps, on eight values. Unpacking works within 128-bit lanes:
+// the two permutes put the values back in order.
+__attribute__((target("avx2"))) inline char *write_int32_list_avx2(char *p, std::span<const int32_t> values) {
+  alignas(32) char digits[8 * 8 + 16];
+  const __m256i magic = _mm256_set1_epi32(int(0xd1b71759));
+  const __m256i ten = _mm256_set1_epi16(10);
+  const __m256i limit = _mm256_set1_epi32(99999999);
+  size_t i = 0;
+  for (; i + 8 <= values.size(); i += 8) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values.data() + i));
+    const __m256i magnitude = _mm256_abs_epi32(v);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_max_epu32(magnitude, limit), limit)) != -1) {
+      p = write_int32_list(p, values.subspan(i, 8));
+      continue;
+    }
+    const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(magnitude, magic), 45);
+    const __m256i odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(magnitude, 32), magic), 45);
+    const __m256i high = _mm256_or_si256(even, _mm256_slli_epi64(odd, 32));
+    const __m256i low = _mm256_sub_epi32(magnitude, _mm256_madd_epi16(high, _mm256_set1_epi32(10000)));
+    const __m256i x = _mm256_or_si256(high, _mm256_slli_epi32(low, 16));
+    const __m256i t1 = div10_avx2(x), t2 = div10_avx2(t1), a = div10_avx2(t2);
+    const __m256i d = _mm256_sub_epi16(x, _mm256_mullo_epi16(t1, ten));
+    const __m256i c = _mm256_sub_epi16(t1, _mm256_mullo_epi16(t2, ten));
+    const __m256i b = _mm256_sub_epi16(t2, _mm256_mullo_epi16(a, ten));
+    const __m256i ab = _mm256_or_si256(a, _mm256_slli_epi16(b, 8));
+    const __m256i cd = _mm256_or_si256(c, _mm256_slli_epi16(d, 8));
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i lo = _mm256_add_epi8(_mm256_unpacklo_epi16(ab, cd), zero); // 0 1 | 4 5
+    const __m256i hi = _mm256_add_epi8(_mm256_unpackhi_epi16(ab, cd), zero); // 2 3 | 6 7
+    _mm256_store_si256(reinterpret_cast<__m256i *>(digits), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_store_si256(reinterpret_cast<__m256i *>(digits + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    const int negative = _mm256_movemask_ps(_mm256_castsi256_ps(v));
+    for (size_t k = 0; k < 8; k++) {
+      p = write_eight_digits(p, digits + 8 * k, (negative >> k) & 1);
+      *p++ = ',';
+    }
+  }
+  return write_int32_list(p, values.subspan(i));
+}
+
+// Sixteen values per iteration.
+__attribute__((target("avx512f,avx512bw"))) inline char *write_int32_list_avx512(char *p,
+                                                                                std::span<const int32_t> values) {
+  alignas(64) char digits[16 * 8 + 16];
+  const __m512i magic = _mm512_set1_epi32(int(0xd1b71759));
+  const __m512i ten = _mm512_set1_epi16(10);
+  const __m512i first_half = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+  const __m512i second_half = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+  size_t i = 0;
+  for (; i + 16 <= values.size(); i += 16) {
+    const __m512i v = _mm512_loadu_si512(values.data() + i);
+    const __m512i magnitude = _mm512_abs_epi32(v);
+    if (_mm512_cmpgt_epu32_mask(magnitude, _mm512_set1_epi32(99999999)) != 0) {
+      p = write_int32_list(p, values.subspan(i, 16));
+      continue;
+    }
+    const __m512i even = _mm512_srli_epi64(_mm512_mul_epu32(magnitude, magic), 45);
+    const __m512i odd = _mm512_srli_epi64(_mm512_mul_epu32(_mm512_srli_epi64(magnitude, 32), magic), 45);
+    const __m512i high = _mm512_or_si512(even, _mm512_slli_epi64(odd, 32));
+    const __m512i low = _mm512_sub_epi32(magnitude, _mm512_madd_epi16(high, _mm512_set1_epi32(10000)));
+    const __m512i x = _mm512_or_si512(high, _mm512_slli_epi32(low, 16));
+    const __m512i t1 = div10_avx512(x), t2 = div10_avx512(t1), a = div10_avx512(t2);
+    const __m512i d = _mm512_sub_epi16(x, _mm512_mullo_epi16(t1, ten));
+    const __m512i c = _mm512_sub_epi16(t1, _mm512_mullo_epi16(t2, ten));
+    const __m512i b = _mm512_sub_epi16(t2, _mm512_mullo_epi16(a, ten));
+    const __m512i ab = _mm512_or_si512(a, _mm512_slli_epi16(b, 8));
+    const __m512i cd = _mm512_or_si512(c, _mm512_slli_epi16(d, 8));
+    const __m512i zero = _mm512_set1_epi8('0');
+    const __m512i lo = _mm512_add_epi8(_mm512_unpacklo_epi16(ab, cd), zero); // 0 1 | 4 5 | 8 9 | 12 13
+    const __m512i hi = _mm512_add_epi8(_mm512_unpackhi_epi16(ab, cd), zero); // 2 3 | 6 7 | ...
+    _mm512_store_si512(digits, _mm512_permutex2var_epi64(lo, first_half, hi));
+    _mm512_store_si512(digits + 64, _mm512_permutex2var_epi64(lo, second_half, hi));
+    const uint32_t negative = _mm512_cmplt_epi32_mask(v, _mm512_setzero_si512());
+    for (size_t k = 0; k < 16; k++) {
+      p = write_eight_digits(p, digits + 8 * k, (negative >> k) & 1);
+      *p++ = ',';
+    }
+  }
+  return write_int32_list(p, values.subspan(i));
+}
+#elif defined(__ARM_NEON)
+inline uint16x8_t div10_neon(uint16x8_t y) {
+  const uint16x4_t tenth = vdup_n_u16(52429);
+  return vshrq_n_u16(vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(y), tenth), 16),
+                                  vshrn_n_u32(vmull_u16(vget_high_u16(y), tenth), 16)),
+                     3);
+}
+
+inline char *write_int32_list_neon(char *p, std::span<const int32_t> values) {
+  alignas(16) char digits[4 * 8 + 16];
+  size_t i = 0;
+  for (; i + 4 <= values.size(); i += 4) {
+    const int32x4_t v = vld1q_s32(values.data() + i);
+    const uint32x4_t magnitude = vreinterpretq_u32_s32(vabsq_s32(v));
+    if (vmaxvq_u32(magnitude) > 99999999) {
+      p = write_int32_list(p, values.subspan(i, 4));
+      continue;
+    }
+    const uint32x2_t magic = vdup_n_u32(0xd1b71759);
+    const uint32x4_t high =
+        vcombine_u32(vmovn_u64(vshrq_n_u64(vmull_u32(vget_low_u32(magnitude), magic), 45)),
+                     vmovn_u64(vshrq_n_u64(vmull_u32(vget_high_u32(magnitude), magic), 45)));
+    const uint32x4_t low = vmlsq_n_u32(magnitude, high, 10000);
+    const uint16x8_t x = vreinterpretq_u16_u32(vorrq_u32(high, vshlq_n_u32(low, 16)));
+    const uint16x8_t t1 = div10_neon(x), t2 = div10_neon(t1), a = div10_neon(t2);
+    const uint16x8_t d = vmlsq_n_u16(x, t1, 10);
+    const uint16x8_t c = vmlsq_n_u16(t1, t2, 10);
+    const uint16x8_t b = vmlsq_n_u16(t2, a, 10);
+    const uint16x8x2_t abcd = vzipq_u16(vorrq_u16(a, vshlq_n_u16(b, 8)), vorrq_u16(c, vshlq_n_u16(d, 8)));
+    const uint8x16_t zero = vdupq_n_u8('0');
+    vst1q_u8(reinterpret_cast<uint8_t *>(digits), vaddq_u8(vreinterpretq_u8_u16(abcd.val[0]), zero));
+    vst1q_u8(reinterpret_cast<uint8_t *>(digits + 16), vaddq_u8(vreinterpretq_u8_u16(abcd.val[1]), zero));
+    for (size_t k = 0; k < 4; k++) {
+      p = write_eight_digits(p, digits + 8 * k, values[i + k] < 0);
+      *p++ = ',';
+    }
+  }
+  return write_int32_list(p, values.subspan(i));
+}
+#endif
+
+using int32_list_function = char *(*)(char *p, std::span<const int32_t> values);
+
+inline int32_list_function select_int32_list() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (cpu_dispatch::supports(cpu_dispatch::avx512bw)) {
+    return write_int32_list_avx512;
+  } else if (cpu_dispatch::supports(cpu_dispatch::avx2)) {
+    return write_int32_list_avx2;
+  } else if (cpu_dispatch::supports(cpu_dispatch::sse2)) {
+    return write_int32_list_sse2;
+  }
+#elif defined(__ARM_NEON)
+  if (cpu_dispatch::supports(cpu_dispatch::neon)) {
+    return write_int32_list_neon;
+  }
+#endif
+  return write_int32_list;
+}
+
+// Worst case per float: "-1.17549435e-38,", from std::to_chars.
+constexpr size_t max_float_chars = 16;
+
+inline constexpr uint64_t decimal_scales[8] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000};
+inline constexpr double decimal_scales_double[8] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000};
+
+inline char *write_float(char *p, float value) {
+  if (!std::isfinite(value)) {
+    std::memcpy(p, "null", 4);
+    return p + 4;
+  }
+  return std::to_chars(p, p + max_float_chars, value).ptr;
+}
+
+inline char *write_float_list(char *p, std::span<const float> values) {
+  for (float v : values) {
+    p = write_float(p, v);
+    *p++ = ',';
+  }
+  return p;
+}
+
+// units / 10^decimals, with exactly `decimals` digits after the point.
+inline char *write_decimal(char *p, bool negative, uint64_t units, int decimals) {
+  *p = '-';
+  p += negative;
+  p = write_int32(p, int32_t(units / decimal_scales[decimals]));
+  if (decimals > 0) {
+    *p++ = '.';
+    uint64_t fraction = units % decimal_scales[decimals];
+    for (int i = decimals - 1; i >= 0; i--) {
+      p[i] = char('0' + fraction % 10);
+      fraction /= 10;
+    }
+    p += decimals;
+  }
+  return p;
+}
+
+// Digits found by a kernel for a block of floats.
+template <size_t N>
+struct short_floats {
+  uint64_t units[N];
+  int decimals[N];
+
+  char *write(char *p, const float *values) const {
+    for (size_t k = 0; k < N; k++) {
+      p = write_decimal(p, std::signbit(values[k]), units[k], decimals[k]);
+      *p++ = ',';
+    }
+    return p;
+  }
+};
+
+inline void append_float_scalar(std::string &out, std::span<const float> values) {
+  end_array(out, write_float_list(begin_array(out, values.size(), max_float_chars), values), values.size());
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// The decimals of four floats, into out from index `at`. False if one of
+// them needs the general path.
+__attribute__((target("avx2"))) inline bool find_decimals_avx2(const float *values, short_floats<8> &out, size_t at) {
+  const __m128 f = _mm_loadu_ps(values);
+  const __m128i bits = _mm_castps_si128(f);
+  const __m256d a = _mm256_cvtps_pd(_mm_andnot_ps(_mm_set1_ps(-0.0f), f));
+  // Half the gap to the next float up, from the exponent; at a power of
+  // two the gap below is half as wide.
+  const __m128i exponent = _mm_and_si128(bits, _mm_set1_epi32(0x7f800000));
+  const __m256d up = _mm256_cvtps_pd(_mm_castsi128_ps(_mm_sub_epi32(exponent, _mm_set1_epi32(24 << 23))));
+  const __m128i power_of_two = _mm_cmpeq_epi32(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_setzero_si128());
+  const __m256d down = _mm256_blendv_pd(up, _mm256_mul_pd(up, _mm256_set1_pd(0.5)),
+                                        _mm256_castsi256_pd(_mm256_cvtepi32_epi64(power_of_two)));
+  const __m256d low = _mm256_sub_pd(a, down);
+  const __m256d high = _mm256_add_pd(a, up);
+  const __m256d in_range = _mm256_and_pd(_mm256_cmp_pd(a, _mm256_set1_pd(1e-3), _CMP_GE_OQ),
+                                         _mm256_cmp_pd(a, _mm256_set1_pd(1e5), _CMP_LT_OQ));
+  // Zeros are done: "0", or "-0".
+  __m256d found = _mm256_cmp_pd(a, _mm256_setzero_pd(), _CMP_EQ_OQ);
+  __m256d units = _mm256_setzero_pd(), decimals = _mm256_setzero_pd();
+  for (int k = 0; k < 8 && _mm256_movemask_pd(found) != 0xf; k++) {
+    const __m256d scale = _mm256_set1_pd(decimal_scales_double[k]);
+    const __m256d scaled = _mm256_mul_pd(a, scale);
+    const __m256d n = _mm256_round_pd(scaled, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d ok = _mm256_and_pd(_mm256_cmp_pd(_mm256_mul_pd(low, scale), n, _CMP_LT_OQ),
+                               _mm256_cmp_pd(n, _mm256_mul_pd(high, scale), _CMP_LT_OQ));
+    ok = _mm256_andnot_pd(found, _mm256_and_pd(ok, in_range));
+    units = _mm256_blendv_pd(units, n, ok);
+    decimals = _mm256_blendv_pd(decimals, _mm256_set1_pd(double(k)), ok);
+    found = _mm256_or_pd(found, ok);
+  }
+  if (_mm256_movemask_pd(found) != 0xf) { return false; }
+  alignas(32) double u[4], d[4];
+  _mm256_store_pd(u, units);
+  _mm256_store_pd(d, decimals);
+  for (size_t k = 0; k < 4; k++) {
+    out.units[at + k] = uint64_t(u[k]);
+    out.decimals[at + k] = int(d[k]);
+  }
+  return true;
+}
+
+__attribute__((target("avx2"))) inline char *write_float_list_avx2(char *p, std::span<const float> values) {
+  short_floats<8> block;
+  size_t i = 0;
+  for (; i + 8 <= values.size(); i += 8) {
+    if (find_decimals_avx2(values.data() + i, block, 0) && find_decimals_avx2(values.data() + i + 4, block, 4)) {
+      p = block.write(p, values.data() + i);
+    } else {
+      p = write_float_list(p, values.subspan(i, 8));
+    }
+  }
+  return write_float_list(p, values.subspan(i));
+}
+
+// The same steps on eight floats, with mask registers.
+__attribute__((target("avx2,avx512f"))) inline bool find_decimals_avx512(const float *values, short_floats<16> &out,
+                                                                         size_t at) {
+  const __m256 f = _mm256_loadu_ps(values);
+  const __m256i bits = _mm256_castps_si256(f);
+  const __m512d a = _mm512_abs_pd(_mm512_cvtps_pd(f));
+  const __m256i exponent = _mm256_and_si256(bits, _mm256_set1_epi32(0x7f800000));
+  const __m512d up = _mm512_cvtps_pd(_mm256_castsi256_ps(_mm256_sub_epi32(exponent, _mm256_set1_epi32(24 << 23))));
+  const __mmask8 power_of_two = __mmask8(_mm256_movemask_ps(_mm256_castsi256_ps(
+      _mm256_cmpeq_epi32(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_setzero_si256()))));
+  const __m512d down = _mm512_mask_mul_pd(up, power_of_two, up, _mm512_set1_pd(0.5));
+  const __m512d low = _mm512_sub_pd(a, down);
+  const __m512d high = _mm512_add_pd(a, up);
+  const __mmask8 in_range =
+      _mm512_cmp_pd_mask(a, _mm512_set1_pd(1e-3), _CMP_GE_OQ) & _mm512_cmp_pd_mask(a, _mm512_set1_pd(1e5), _CMP_LT_OQ);
+  __mmask8 found = _mm512_cmp_pd_mask(a, _mm512_setzero_pd(), _CMP_EQ_OQ);
+  __m512d units = _mm512_setzero_pd(), decimals = _mm512_setzero_pd();
+  for (int k = 0; k < 8 && found != 0xff; k++) {
+    const __m512d scale = _mm512_set1_pd(decimal_scales_double[k]);
+    const __m512d scaled = _mm512_mul_pd(a, scale);
+    const __m512d n = _mm512_roundscale_pd(scaled, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    const __mmask8 ok = _mm512_cmp_pd_mask(_mm512_mul_pd(low, scale), n, _CMP_LT_OQ) &
+                        _mm512_cmp_pd_mask(n, _mm512_mul_pd(high, scale), _CMP_LT_OQ) & in_range & ~found;
+    units = _mm512_mask_blend_pd(ok, units, n);
+    decimals = _mm512_mask_blend_pd(ok, decimals, _mm512_set1_pd(double(k)));
+    found |= ok;
+  }
+  if (found != 0xff) { return false; }
+  alignas(64) double u[8], d[8];
+  _mm512_store_pd(u, units);
+  _mm512_store_pd(d, decimals);
+  for (size_t k = 0; k < 8; k++) {
+    out.units[at + k] = uint64_t(u[k]);
+    out.decimals[at + k] = int(d[k]);
+  }
+  return true;
+}
+
+__attribute__((target("avx2,avx512f"))) inline char *write_float_list_avx512(char *p, std::span<const float> values) {
+  short_floats<16> block;
+  size_t i = 0;
+  for (; i + 16 <= values.size(); i += 16) {
+    if (find_decimals_avx512(values.data() + i, block, 0) && find_decimals_avx512(values.data() + i + 8, block, 8)) {
+      p = block.write(p, values.data() + i);
+    } else {
+      p = write_float_list(p, values.subspan(i, 16));
+    }
+  }
+  return write_float_list(p, values.subspan(i));
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+// Two of the four lanes: a and up as doubles, power_of_two as a 64-bit mask.
+inline bool find_decimals_neon(float64x2_t a, float64x2_t up, uint64x2_t power_of_two, short_floats<4> &out,
+                               size_t at) {
+  const float64x2_t down = vbslq_f64(power_of_two, vmulq_n_f64(up, 0.5), up);
+  const float64x2_t low = vsubq_f64(a, down);
+  const float64x2_t high = vaddq_f64(a, up);
+  const uint64x2_t in_range = vandq_u64(vcgeq_f64(a, vdupq_n_f64(1e-3)), vcltq_f64(a, vdupq_n_f64(1e5)));
+  uint64x2_t found = vceqq_f64(a, vdupq_n_f64(0));
+  float64x2_t units = vdupq_n_f64(0), decimals = vdupq_n_f64(0);
+  for (int k = 0; k < 8 && vminvq_u32(vreinterpretq_u32_u64(found)) == 0; k++) {
+    const double scale = decimal_scales_double[k];
+    const float64x2_t scaled = vmulq_n_f64(a, scale);
+    const float64x2_t n = vrndnq_f64(scaled);
+    uint64x2_t ok = vandq_u64(vcltq_f64(vmulq_n_f64(low, scale), n), vcltq_f64(n, vmulq_n_f64(high, scale)));
+    ok = vbicq_u64(vandq_u64(ok, in_range), found);
+    units = vbslq_f64(ok, n, units);
+    decimals = vbslq_f64(ok, vdupq_n_f64(double(k)), decimals);
+    found = vorrq_u64(found, ok);
+  }
+  if (vminvq_u32(vreinterpretq_u32_u64(found)) == 0) { return false; }
+  out.units[at] = uint64_t(vgetq_lane_f64(units, 0));
+  out.units[at + 1] = uint64_t(vgetq_lane_f64(units, 1));
+  out.decimals[at] = int(vgetq_lane_f64(decimals, 0));
+  out.decimals[at + 1] = int(vgetq_lane_f64(decimals, 1));
+  return true;
+}
+
+inline char *write_float_list_neon(char *p, std::span<const float> values) {
+  short_floats<4> block;
+  size_t i = 0;
+  for (; i + 4 <= values.size(); i += 4) {
+    const float32x4_t f = vld1q_f32(values.data() + i);
+    const uint32x4_t bits = vreinterpretq_u32_f32(f);
+    const float32x4_t a = vabsq_f32(f);
+    const float32x4_t up = vreinterpretq_f32_u32(vsubq_u32(vandq_u32(bits, vdupq_n_u32(0x7f800000)), vdupq_n_u32(24u << 23)));
+    // Sign-extended, so that each 64-bit mask is all ones or all zeros.
+    const int32x4_t power_of_two = vreinterpretq_s32_u32(vceqq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0)));
+    const bool fast =
+        find_decimals_neon(vcvt_f64_f32(vget_low_f32(a)), vcvt_f64_f32(vget_low_f32(up)),
+                           vreinterpretq_u64_s64(vmovl_s32(vget_low_s32(power_of_two))), block, 0) &&
+        find_decimals_neon(vcvt_high_f64_f32(a), vcvt_high_f64_f32(up),
+                           vreinterpretq_u64_s64(vmovl_high_s32(power_of_two)), block, 2);
+    p = fast ? block.write(p, values.data() + i) : write_float_list(p, values.subspan(i, 4));
+  }
+  return write_float_list(p, values.subspan(i));
+}
+#endif
+
+using float_list_function = char *(*)(char *p, std::span<const float> values);
+
+inline float_list_function select_float_list() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (cpu_dispatch::supports(cpu_dispatch::avx2 | cpu_dispatch::avx512f)) {
+    return write_float_list_avx512;
+  } else if (cpu_dispatch::supports(cpu_dispatch::avx2)) {
+    return write_float_list_avx2;
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  if (cpu_dispatch::supports(cpu_dispatch::neon)) {
+    return write_float_list_neon;
+  }
+#endif
+  return write_float_list;
+}
+
+// Worst case per value of T, with its comma.
+template <typename T>
+inline constexpr size_t max_chars = std::is_same_v<T, int32_t> ? max_int32_chars
+                                    : std::is_same_v<T, float> ? max_float_chars
+                                                               : 32;
+
+// "v," for each value, with the kernel for T.
+template <typename T>
+char *write_list(char *p, std::span<const T> values) {
+  if constexpr (std::is_same_v<T, int32_t>) {
+    return cpu_dispatch::dispatched<select_int32_list>::call(p, values);
+  } else if constexpr (std::is_same_v<T, float>) {
+    return cpu_dispatch::dispatched<select_float_list>::call(p, values);
+  } else {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "append_array writes arrays of numbers");
+    for (T v : values) {
+      if constexpr (std::is_floating_point_v<T>) {
+        if (!std::isfinite(v)) {
+          std::memcpy(p, "null,", 5);
+          p += 5;
+          continue;
+        }
+      }
+      p = std::to_chars(p, p + max_chars<T>, v).ptr;
+      *p++ = ',';
+    }
+    return p;
+  }
+}
+
+template <typename T>
+void count_formatted(size_t count) {
+  instrumentation::add(std::is_floating_point_v<T> ? instrumentation::floats_formatted_shortest
+                                                   : instrumentation::integers_formatted,
+                       count);
+}
+
+template <typename T>
+void append_array(std::string &out, std::span<const T> values) {
+  count_formatted<T>(values.size());
+  end_array(out, write_list(begin_array(out, values.size(), max_chars<T>), values), values.size());
+}
+
+template <typename T, typename A>
+void append_array(std::string &out, const std::vector<T, A> &values) {
+  append_array(out, std::span<const T>(values));
+}
+
+#if SIMDJSON_STATIC_REFLECTION
+// The builder does not hand out its buffer: blocks of values are written
+// to the stack, which stays in L1, then appended. No copy of the whole
+// array is made. append_list() leaves out the brackets, for callers that
+// write an array in pieces.
+template <typename T>
+void append_list(simdjson::builder::string_builder &b, std::span<const T> values) {
+  constexpr size_t block = 256;
+  char buffer[block * max_chars<T> + 16];
+  count_formatted<T>(values.size());
+  for (size_t i = 0; i < values.size(); i += block) {
+    const size_t count = std::min(block, values.size() - i);
+    char *end = write_list(buffer, values.subspan(i, count));
+    // Without the comma after the last value.
+    if (i + count == values.size()) { end--; }
+    b.append_raw(std::string_view(buffer, size_t(end - buffer)));
+  }
+}
+
+template <typename T>
+void append_array(simdjson::builder::string_builder &b, std::span<const T> values) {
+  b.append('[');
+  append_list(b, values);
+  b.append(']');
+}
+
+template <typename T, typename A>
+void append_array(simdjson::builder::string_builder &b, const std::vector<T, A> &values) {
+  append_array(b, std::span<const T>(values));
+}
+#endif
+
+} // namespace number_array
+
+namespace simdjson {
+
+// Annotation: write this std::vector of numbers with
+// number_array::append_array() in to_json_formatted().
+struct batched {};
+
+} // namespace simdjson
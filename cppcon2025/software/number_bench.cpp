@@ -0,0 +1,132 @@
+// Arrays of int32 and of float: one number at a time (fmt, and simdjson's
+// builder) versus number_array's batched writer, scalar and with the SIMD
+// kernel picked at runtime, into a std::string and into a builder (what
+// [[=simdjson::batched{}]] members get). We check that they agree first.
+//
+// Usage: ./number_bench [arrays] [length]
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "number_array.h"
+
+template <typename T>
+std::string fmt_array(const std::vector<T> &values) {
+  std::string out = "[";
+  for (size_t i = 0; i < values.size(); i++) {
+    if (i > 0) { out += ','; }
+    fmt::format_to(std::back_inserter(out), "{}", values[i]);
+  }
+  out += ']';
+  return out;
+}
+
+template <typename T>
+std::string builder_array(const std::vector<T> &values) {
+  simdjson::builder::string_builder b;
+  b.append('[');
+  for (size_t i = 0; i < values.size(); i++) {
+    if (i > 0) { b.append(','); }
+    b.append(values[i]);
+  }
+  b.append(']');
+  std::string_view json;
+  if (b.view().get(json)) { std::abort(); }
+  return std::string(json);
+}
+
+template <typename T, typename F>
+void bench(const char *name, const std::vector<std::vector<T>> &arrays, F serialize) {
+  size_t volume = 0;
+  for (const auto &values : arrays) { volume += serialize(values).size(); }
+  size_t rounds = 0;
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed{};
+  do {
+    for (const auto &values : arrays) {
+      std::string json = serialize(values);
+      asm volatile("" : : "r"(json.data()) : "memory");
+    }
+    rounds++;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < 0.5);
+  fmt::print("{:<36} : {:10.2f} MB/s\n", name, double(volume) * double(rounds) / 1e6 / elapsed.count());
+}
+
+// scalar is number_array's portable writer for T. fmt and to_chars write
+// the same shortest floats at these magnitudes.
+template <typename T, typename Scalar>
+bool run(const char *type, const std::vector<std::vector<T>> &arrays, Scalar scalar_writer) {
+  auto into_builder = [](const std::vector<T> &values) {
+    simdjson::builder::string_builder b;
+    number_array::append_array(b, values);
+    std::string_view json;
+    if (b.view().get(json)) { std::abort(); }
+    return std::string(json);
+  };
+  auto scalar = [scalar_writer](const std::vector<T> &values) {
+    std::string json;
+    scalar_writer(json, values);
+    return json;
+  };
+  auto batched = [](const std::vector<T> &values) {
+    std::string json;
+    number_array::append_array(json, values);
+    return json;
+  };
+  for (const auto &values : arrays) {
+    const std::string expected = fmt_array(values);
+    if (into_builder(values) != expected || scalar(values) != expected || batched(values) != expected) {
+      fmt::print(stderr, "mismatch: {}\n", expected);
+      return false;
+    }
+  }
+  fmt::print("# {} arrays of {} {}\n", arrays.size(), arrays.empty() ? 0 : arrays[0].size(), type);
+  bench("fmt, one at a time", arrays, fmt_array<T>);
+  bench("builder, one at a time", arrays, builder_array<T>);
+  bench("number_array (scalar)", arrays, scalar);
+  bench("number_array (dispatched)", arrays, batched);
+  bench("number_array into a builder", arrays, into_builder);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 10000;
+  size_t length = argc > 2 ? std::stoul(argv[2]) : 64;
+  std::mt19937 rng(1234);
+  // Mostly small values, like years and counters, with some large ones.
+  std::vector<std::vector<int32_t>> integers(count);
+  for (auto &values : integers) {
+    values.resize(length);
+    for (int32_t &v : values) {
+      v = rng() % 16 == 0 ? int32_t(rng()) : int32_t(rng() % 20000) - 1000;
+    }
+  }
+  // Sensor readings with one or two decimals, like the weather columns,
+  // and now and then a value that needs all its digits.
+  std::vector<std::vector<float>> floats(count);
+  for (auto &values : floats) {
+    values.resize(length);
+    for (float &v : values) {
+      v = rng() % 32 == 0 ? float(rng() % 100000000) / 1000.0f : float(int(rng() % 40000) - 10000) / (rng() % 2 ? 10.0f : 100.0f);
+    }
+  }
+  if (!run("int32", integers, [](std::string &out, std::span<const int32_t> values) {
+        number_array::append_int32_scalar(out, values);
+      })) {
+    return EXIT_FAILURE;
+  }
+  if (!run("float", floats, [](std::string &out, std::span<const float> values) {
+        number_array::append_float_scalar(out, values);
+      })) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <simdjson.h>
+
+#include "instrumentation.h"
+
+/**
+ * A growable buffer that always keeps SIMDJSON_PADDING bytes of slack past its
+ * end, so that simdjson can parse it in place: no simdjson::pad() copy.
+ */
+class padded_buffer {
+public:
+    padded_buffer() = default;
+    padded_buffer(padded_buffer &&other) noexcept
+        : data(std::move(other.data)), length(std::exchange(other.length, 0)),
+          buffer_capacity(std::exchange(other.buffer_capacity, 0)) {}
+    padded_buffer& operator=(padded_buffer &&other) noexcept {
+        data = std::move(other.data);
+        length = std::exchange(other.length, 0);
+        buffer_capacity = std::exchange(other.buffer_capacity, 0);
+        return *this;
+    }
+    void reserve(size_t new_capacity) {
+        if (new_capacity <= buffer_capacity) { return; }
+        instrumentation::add(instrumentation::buffer_growths);
+        std::unique_ptr<char[]> new_data(new char[new_capacity + simdjson::SIMDJSON_PADDING]);
+        if (length > 0) { std::memcpy(new_data.get(), data.get(), length); }
+        data = std::move(new_data);
+        buffer_capacity = new_capacity;
+    }
+    void append(const char *bytes, size_t n) {
+        if (length + n > buffer_capacity) {
+            reserve(std::max(length + n, 2 * buffer_capacity));
+        }
+        std::memcpy(data.get() + length, bytes, n);
+        length += n;
+    }
+    void clear() { length = 0; }
+    size_t size() const { return length; }
+    size_t capacity() const { return buffer_capacity; }
+    // The padding must be readable, we zero it for good measure.
+    simdjson::padded_string_view view() {
+        reserve(1);
+        std::memset(data.get() + length, 0, simdjson::SIMDJSON_PADDING);
+        return simdjson::padded_string_view(data.get(), length, buffer_capacity + simdjson::SIMDJSON_PADDING);
+    }
+private:
+    std::unique_ptr<char[]> data;
+    size_t length{0};
+    size_t buffer_capacity{0};
+};
@@ -0,0 +1,112 @@
+// Parsing Car documents three ways: hand-written ondemand code, the
+// reflection-based doc.get<Car>(), and compiled_parser<Car>, which walks
+// the bytes and only falls back to ondemand on unexpected input. Escapes
+// in the strings force such fallbacks, so each escape density gets its
+// own run, with the share of documents that took the fallback.
+//
+// Usage: ./parse_bench [cars] [rounds]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include "../compiler_explorer_manual_vs_reflection.cpp"
+#include "compiled_parser.h"
+
+std::string random_text(std::mt19937 &rng, size_t length, unsigned escape_per_mille) {
+    std::string text(length, ' ');
+    for (char &c : text) {
+        c = rng() % 1000 < escape_per_mille ? '"' : char('a' + rng() % 26);
+    }
+    return text;
+}
+
+std::vector<simdjson::padded_string> random_documents(size_t count, unsigned escape_per_mille) {
+    std::mt19937 rng(1234);
+    std::vector<simdjson::padded_string> documents;
+    documents.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        Car car{random_text(rng, 1 + rng() % 64, escape_per_mille),
+                random_text(rng, 1 + rng() % 64, escape_per_mille),
+                int(1950 + rng() % 75), {}};
+        for (size_t j = rng() % 8; j > 0; j--) {
+            car.tire_pressure.push_back(float(rng() % 500) / 10.0f);
+        }
+        documents.emplace_back(serialize_reflection(car));
+    }
+    return documents;
+}
+
+simdjson::error_code parse_manual(simdjson::ondemand::parser &parser, const simdjson::padded_string &json, Car &car) {
+    simdjson::ondemand::document doc;
+    auto error = parser.iterate(json).get(doc);
+    if (error) { return error; }
+    std::string_view text;
+    if ((error = doc["make"].get_string().get(text))) { return error; }
+    car.make = text;
+    if ((error = doc["model"].get_string().get(text))) { return error; }
+    car.model = text;
+    int64_t year;
+    if ((error = doc["year"].get_int64().get(year))) { return error; }
+    car.year = int(year);
+    simdjson::ondemand::array pressures;
+    if ((error = doc["tire_pressure"].get_array().get(pressures))) { return error; }
+    car.tire_pressure.clear();
+    for (auto pressure : pressures) {
+        double value;
+        if ((error = pressure.get_double().get(value))) { return error; }
+        car.tire_pressure.push_back(float(value));
+    }
+    return simdjson::SUCCESS;
+}
+
+template <typename F>
+void bench(const char *name, const std::vector<simdjson::padded_string> &documents, size_t rounds, F parse) {
+    size_t volume = 0;
+    for (const auto &json : documents) { volume += json.size(); }
+    Car car;
+    // Warm up.
+    for (const auto &json : documents) {
+        if (parse(json, car)) { std::abort(); }
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (const auto &json : documents) {
+            if (parse(json, car)) { std::abort(); }
+            asm volatile("" : : "r"(car.make.data()) : "memory");
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fmt::print("{:<26} {:>10.3f}\n", name, double(volume) * double(rounds) / seconds / 1e9);
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 3;
+    for (unsigned escape_per_mille : {0u, 10u}) {
+        std::vector<simdjson::padded_string> documents = random_documents(count, escape_per_mille);
+        fmt::print("# {} cars, {} rounds, {} escapes per thousand bytes\n", count, rounds, escape_per_mille);
+        fmt::print("{:<26} {:>10}\n", "parser", "GB/s");
+        simdjson::ondemand::parser parser;
+        bench("ondemand (manual)", documents, rounds, [&](const simdjson::padded_string &json, Car &car) {
+            return parse_manual(parser, json, car);
+        });
+        bench("ondemand get<Car>()", documents, rounds, [&](const simdjson::padded_string &json, Car &car) {
+            simdjson::ondemand::document doc;
+            auto error = parser.iterate(json).get(doc);
+            if (error) { return error; }
+            return doc.get(car);
+        });
+        simdjson::compiled_parser<Car> compiled;
+        bench("compiled_parser<Car>", documents, rounds, [&](const simdjson::padded_string &json, Car &car) {
+            return compiled.parse(json, car);
+        });
+        const size_t total = compiled.compiled_parses() + compiled.fallback_parses();
+        fmt::print("{:<26} {:>9.1f}%\n", "  fallback", 100.0 * double(compiled.fallback_parses()) / double(total));
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+// High-frequency game-state updates: one or two members of a player change
+// per tick. We serialize the whole player every tick with to_json(), then
+// keep it up to date with incremental_json::update(), then send a JSON
+// Patch per tick instead, and compare time and bytes.
+//
+// Usage: ./patch_bench [ticks]
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "json_patch.h"
+
+struct GamePlayer {
+  std::string username;
+  int level;
+  double health;
+  double x;
+  double y;
+  std::vector<std::string> inventory;
+  std::vector<int64_t> achievements;
+  std::string guild_name;
+};
+
+GamePlayer make_player() {
+  GamePlayer p{"Alice", 42, 99.5, 1024.25, -512.75, {"sword", "shield", "potion", "map", "lantern"}, {}, "Night's Watch"};
+  for (int64_t i = 0; i < 32; i++) { p.achievements.push_back(1700000000 + i * 3600); }
+  return p;
+}
+
+// Most ticks change the health, one in sixteen the level too.
+void tick(GamePlayer &p, size_t t) {
+  p.health = 50.0 + double(t % 97) * 0.5;
+  if (t % 16 == 0) { p.level++; }
+}
+
+template <typename F>
+void bench(const char *name, size_t ticks, F step) {
+  GamePlayer p = make_player();
+  size_t bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < ticks; t++) {
+    tick(p, t);
+    bytes += step(p);
+  }
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  fmt::print("{:<28} {:>10.1f} {:>14.1f}\n", name, seconds * 1e9 / double(ticks), double(bytes) / double(ticks));
+}
+
+int main(int argc, char **argv) {
+  const size_t ticks = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  // The incremental form must match the full one.
+  {
+    GamePlayer p = make_player();
+    simdjson::incremental_json<GamePlayer> state(p);
+    for (size_t t = 0; t < 100; t++) {
+      tick(p, t);
+      state.update(p);
+      std::string full = simdjson::to_json(p);
+      if (state.json() != full) {
+        fmt::print(stderr, "incremental form differs from to_json():\n{}\n{}\n", state.json(), full);
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  fmt::print("{:<28} {:>10} {:>14}\n", "per tick", "ns", "bytes sent");
+  bench("to_json() every tick", ticks, [](const GamePlayer &p) {
+    std::string json = simdjson::to_json(p);
+    return json.size();
+  });
+  GamePlayer initial = make_player();
+  simdjson::incremental_json<GamePlayer> state(initial);
+  bench("incremental_json::update()", ticks, [&state](const GamePlayer &p) {
+    state.update(p);
+    return state.json().size();
+  });
+  simdjson::incremental_json<GamePlayer> patched(initial);
+  bench("incremental_json::patch()", ticks, [&patched](const GamePlayer &p) {
+    return patched.patch(p).size();
+  });
+  return EXIT_SUCCESS;
+}
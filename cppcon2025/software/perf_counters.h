@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Cycles, instructions and branch misses for the current thread, read as one
+ * perf_event group so that the three counts cover the same interval. On
+ * hosts without perf events (other systems, containers without
+ * CAP_PERFMON, perf_event_paranoid too high) available() is false and the
+ * samples read as zero.
+ */
+class perf_counters {
+public:
+    struct sample {
+        uint64_t cycles{0};
+        uint64_t instructions{0};
+        uint64_t branch_misses{0};
+        double instructions_per_cycle() const { return cycles ? double(instructions) / double(cycles) : 0; }
+    };
+
+#if defined(__linux__)
+    perf_counters() {
+        leader = open_counter(PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (leader == -1) { return; }
+        instructions = open_counter(PERF_COUNT_HW_INSTRUCTIONS, leader);
+        branch_misses = open_counter(PERF_COUNT_HW_BRANCH_MISSES, leader);
+        if (instructions == -1 || branch_misses == -1) { close_all(); }
+    }
+    ~perf_counters() { close_all(); }
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    bool available() const { return leader != -1; }
+
+    void start() {
+        if (!available()) { return; }
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    sample stop() {
+        sample result;
+        if (!available()) { return result; }
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        // PERF_FORMAT_GROUP: the number of counters, then their values.
+        uint64_t values[4] = {};
+        if (read(leader, values, sizeof(values)) >= ssize_t(sizeof(uint64_t) * 4)) {
+            result.cycles = values[1];
+            result.instructions = values[2];
+            result.branch_misses = values[3];
+        }
+        return result;
+    }
+
+private:
+    static int open_counter(uint64_t config, int group) {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = group == -1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+    void close_all() {
+        for (int *fd : {&branch_misses, &instructions, &leader}) {
+            if (*fd != -1) { close(*fd); *fd = -1; }
+        }
+    }
+
+    int leader{-1};
+    int instructions{-1};
+    int branch_misses{-1};
+#else
+    bool available() const { return false; }
+    void start() {}
+    sample stop() { return {}; }
+#endif
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cmath>
+#include <iterator>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fmt/format.h>
+#include <fmt/core.h>
+
+#include "json_escape.h"
+
+struct Player {
+  std::string username;
+  int level;
+  double health;
+  std::vector<std::string> inventory;
+  bool operator<=>(const Player &other) const = default;
+};
+
+inline std::string to_json_string(const Player &p) {
+  return nlohmann::json{{"username", p.username},
+                        {"level", p.level},
+                        {"health", p.health},
+                        {"inventory", p.inventory}}
+      .dump();
+}
+
+inline void to_json(nlohmann::json &j, const Player &p) {
+  j = nlohmann::json{{"username", p.username},
+                     {"level", p.level},
+                     {"health", p.health},
+                     {"inventory", p.inventory}};
+}
+
+inline Player from_json_string(const std::string& json_str) {
+    nlohmann::json j = nlohmann::json::parse(json_str);
+    Player p;
+    j.at("username").get_to(p.username);
+    j.at("level").get_to(p.level);
+    j.at("health").get_to(p.health);
+    j.at("inventory").get_to(p.inventory);
+    return p;
+}
+
+inline std::string escape_json(const std::string& str) {
+    std::string out;
+    json_escape::escape_to(out, str);
+    return out;
+}
+
+inline std::string serialize_player(const Player& p, json_escape::escape_function escape = json_escape::escape_to) {
+    std::string out = "{\"username\":\"";
+    escape(out, p.username);
+    fmt::format_to(std::back_inserter(out),
+        "\","
+        "\"level\":{},"
+        "\"health\":{},"
+        "\"inventory\":[",
+        p.level,
+        std::isfinite(p.health) ? p.health : -1.0);
+    // fmt's range formatting would quote and escape the items a second time.
+    for (size_t i = 0; i < p.inventory.size(); ++i) {
+        if (i > 0) { out.push_back(','); }
+        out.push_back('"');
+        escape(out, p.inventory[i]);
+        out.push_back('"');
+    }
+    out.append("]}");
+    return out;
+}
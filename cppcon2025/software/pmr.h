@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <meta>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <simdjson.h>
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+#include "column_deserialize.h"
+
+/**
+ * Reflected deserialization into std::pmr containers, with every string and
+ * vector of the decoded graph allocated from a caller-supplied
+ * memory_resource:
+ *
+ *   struct Player {
+ *     std::pmr::string username;
+ *     int level;
+ *     double health;
+ *     std::pmr::vector<std::pmr::string> inventory;
+ *   };
+ *
+ *   simdjson::arena arena(64 * 1024);   // one per thread
+ *   ...                                 // per request:
+ *   Player p = simdjson::make_with_resource<Player>(arena.resource());
+ *   auto error = doc.get(p);
+ *   ...                                 // or, into an existing value:
+ *   error = simdjson::get_with_resource(doc, p, arena.resource());
+ *   ...
+ *   arena.reset();                      // frees the whole graph at once
+ *
+ * make_with_resource() walks the members by reflection and builds each
+ * std::pmr container, including those in nested structs, on the resource.
+ * The overloads below keep it that way while parsing: vector elements are
+ * constructed on the vector's resource (std::pmr::string through
+ * uses-allocator construction, reflected structs through
+ * make_with_resource), and arrays are counted first so that a vector is
+ * allocated once instead of once per growth step, which a monotonic arena
+ * would not give back. Vectors of float or double take the fast path of
+ * column_deserialize.h, as std::vector columns do.
+ *
+ * A default-constructed member uses the default resource; so does a copy
+ * (copying a std::pmr container does not propagate its resource). Move
+ * the decoded values, or construct them with make_with_resource().
+ */
+namespace simdjson {
+namespace pmr_details {
+
+template <typename T>
+concept resource_aware = std::uses_allocator_v<T, std::pmr::polymorphic_allocator<>>;
+
+template <typename T>
+concept reflected_aggregate = std::is_class_v<T> && std::is_aggregate_v<T> && !resource_aware<T>;
+
+// Rebuilds the std::pmr containers of out, which must hold no data yet,
+// on resource.
+template <typename T>
+void rebind(T &out, std::pmr::memory_resource *resource) {
+  if constexpr (resource_aware<T>) {
+    std::destroy_at(&out);
+    std::construct_at(&out, std::pmr::polymorphic_allocator<>(resource));
+  } else if constexpr (reflected_aggregate<T>) {
+    template for (constexpr auto member : std::define_static_array(
+                      std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()))) {
+      rebind(out.[:member:], resource);
+    }
+  }
+}
+
+} // namespace pmr_details
+
+template <typename T>
+T make_with_resource(std::pmr::memory_resource *resource) {
+  T out{};
+  pmr_details::rebind(out, resource);
+  return out;
+}
+
+// Parses val into out, whose std::pmr containers are first rebuilt on
+// resource (out loses its previous content).
+template <typename simdjson_value, typename T>
+error_code get_with_resource(simdjson_value &val, T &out, std::pmr::memory_resource *resource) {
+  pmr_details::rebind(out, resource);
+  return val.get(out);
+}
+
+// A monotonic arena over a buffer of its own, reset per request. Not
+// thread-safe: one per thread. Past the buffer, it falls back to the heap
+// until the next reset().
+class arena {
+public:
+  explicit arena(size_t size)
+      : buffer(std::make_unique<std::byte[]>(size)), monotonic(buffer.get(), size, std::pmr::new_delete_resource()) {}
+  std::pmr::memory_resource *resource() { return &monotonic; }
+  void reset() { monotonic.release(); }
+
+private:
+  std::unique_ptr<std::byte[]> buffer;
+  std::pmr::monotonic_buffer_resource monotonic;
+};
+
+template <typename simdjson_value>
+error_code tag_invoke(deserialize_tag, simdjson_value &val, std::pmr::string &out) {
+  std::string_view str;
+  auto error = val.get_string().get(str);
+  if (error) { return error; }
+  out.assign(str);
+  return SUCCESS;
+}
+
+template <typename simdjson_value, typename U>
+error_code tag_invoke(deserialize_tag, simdjson_value &val, std::pmr::vector<U> &out) {
+  if constexpr (column_details::float_column<std::pmr::vector<U>>) {
+    return deserialize_column(val, out);
+  }
+  ondemand::array array;
+  auto error = val.get_array().get(array);
+  if (error) { return error; }
+  size_t count;
+  error = array.count_elements().get(count);
+  if (error) { return error; }
+  out.clear();
+  out.reserve(count);
+  for (auto element : array) {
+    ondemand::value value;
+    error = element.get(value);
+    if (error) { return error; }
+    U &item = out.emplace_back();
+    if constexpr (pmr_details::reflected_aggregate<U>) {
+      pmr_details::rebind(item, out.get_allocator().resource());
+    }
+    error = value.get(item);
+    if (error) { return error; }
+  }
+  return SUCCESS;
+}
+
+} // namespace simdjson
@@ -0,0 +1,88 @@
+// Request handlers decoding a player with a large inventory, for 1..N
+// threads: into std::string and std::vector on the global heap, then into
+// std::pmr containers on a per-thread arena reset after each request.
+//
+// Usage: ./pmr_bench [requests per thread] [max_threads]
+#include <chrono>
+#include <cstdlib>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "player.h"
+#include "pmr.h"
+#include "thread_pool.h"
+
+struct PmrPlayer {
+  std::pmr::string username;
+  int level;
+  double health;
+  std::pmr::vector<std::pmr::string> inventory;
+};
+
+std::vector<simdjson::padded_string> random_players(size_t count) {
+  std::mt19937 rng(1234);
+  // Past the small-string buffer, so that every item allocates.
+  auto text = [&rng](size_t length) {
+    std::string s(length, ' ');
+    for (char &c : s) { c = char('a' + rng() % 26); }
+    return s;
+  };
+  std::vector<simdjson::padded_string> players;
+  for (size_t i = 0; i < count; i++) {
+    Player p{text(20 + rng() % 16), int(rng() % 100), double(rng() % 1000) / 10.0, {}};
+    for (size_t j = 0; j < 64; j++) { p.inventory.push_back(text(20 + rng() % 24)); }
+    players.emplace_back(serialize_player(p));
+  }
+  return players;
+}
+
+// Requests per second over all threads.
+template <typename F>
+double run(thread_pool &pool, size_t requests, F handle) {
+  auto start = std::chrono::steady_clock::now();
+  pool.parallel_for(pool.size(), [&](size_t) {
+    for (size_t i = 0; i < requests; i++) { handle(i); }
+  });
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return double(requests * pool.size()) / seconds;
+}
+
+int main(int argc, char **argv) {
+  const size_t requests = argc > 1 ? std::stoul(argv[1]) : 20000;
+  const size_t max_threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+  const std::vector<simdjson::padded_string> players = random_players(256);
+  fmt::print("{:>8} {:>16} {:>16}\n", "threads", "heap req/s", "arena req/s");
+  // Powers of two, then max_threads.
+  std::vector<size_t> counts;
+  for (size_t threads = 1; threads < max_threads; threads *= 2) { counts.push_back(threads); }
+  counts.push_back(max_threads);
+  for (size_t threads : counts) {
+    thread_pool pool(threads);
+    const double heap = run(pool, requests, [&players](size_t i) {
+      thread_local simdjson::ondemand::parser parser;
+      simdjson::ondemand::document doc;
+      Player p;
+      if (parser.iterate(players[i % players.size()]).get(doc) || doc.get(p)) { std::abort(); }
+      if (p.inventory.size() != 64) { std::abort(); }
+    });
+    const double arena = run(pool, requests, [&players](size_t i) {
+      thread_local simdjson::ondemand::parser parser;
+      thread_local simdjson::arena arena(64 * 1024);
+      simdjson::ondemand::document doc;
+      {
+        PmrPlayer p = simdjson::make_with_resource<PmrPlayer>(arena.resource());
+        if (parser.iterate(players[i % players.size()]).get(doc) || doc.get(p)) { std::abort(); }
+        if (p.inventory.size() != 64) { std::abort(); }
+      }
+      arena.reset();
+    });
+    fmt::print("{:>8} {:>16.0f} {:>16.0f}\n", threads, heap, arena);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <meta>
+#include <string_view>
+#include <type_traits>
+#include <simdjson.h>
+
+#include "key_table.h"
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * Partial deserialization: materialize only the members you ask for and
+ * leave everything else in the input untouched. Unrequested values are
+ * skipped without being parsed: ondemand walks their structural tokens,
+ * converting nothing. Once the last requested member has been read we stop
+ * matching keys; the rest of the object is still skipped the same way
+ * when the iterator moves past it.
+ *
+ * Either declare a lighter view struct, whose members are the keys you
+ * want, and opt in with a tag_invoke, so that from() and get<T>() use it:
+ *
+ *   struct PlayerSummary { std::string username; int level; };
+ *
+ *   namespace simdjson {
+ *   template <typename simdjson_value>
+ *   auto tag_invoke(deserialize_tag, simdjson_value &val, PlayerSummary &p) {
+ *     return deserialize_projection(val, p);
+ *   }
+ *   }
+ *
+ * or fill some members of the full type, named by member pointers:
+ *
+ *   Player p;
+ *   auto error = simdjson::deserialize_fields<&Player::username, &Player::level>(val, p);
+ *
+ * Members that are not requested keep their value. A requested member that
+ * is missing is an error (NO_SUCH_FIELD), except for std::optional members.
+ */
+namespace simdjson {
+namespace projection_details {
+
+template <typename T, auto Member>
+consteval std::meta::info member_of() {
+  template for (constexpr auto member : key_table_details::members<T>) {
+    if constexpr (std::is_same_v<decltype(&[:member:]), decltype(Member)>) {
+      if (&[:member:] == Member) { return member; }
+    }
+  }
+  return std::meta::info{};
+}
+
+template <typename T, auto... Members>
+struct fields {
+  static_assert(((member_of<T, Members>() != std::meta::info{}) && ...),
+                "deserialize_fields takes pointers to non-static data members of T");
+  static constexpr std::array<std::string_view, sizeof...(Members)> names{
+      std::meta::identifier_of(member_of<T, Members>())...};
+  static constexpr std::array<error_code (*)(ondemand::value &, T &), sizeof...(Members)> parsers{
+      &key_table_details::parse_member<T, member_of<T, Members>()>...};
+  static constexpr std::bitset<sizeof...(Members)> required = [] {
+    std::bitset<sizeof...(Members)> required;
+    size_t i = 0;
+    ((required[i++] = !key_table_details::is_optional<
+          typename[:std::meta::type_of(member_of<T, Members>()):]>::value),
+     ...);
+    return required;
+  }();
+
+  // A handful of names: a linear scan beats hashing.
+  static size_t find(std::string_view key) {
+    for (size_t i = 0; i < names.size(); i++) {
+      if (names[i] == key) { return i; }
+    }
+    return names.size();
+  }
+};
+
+} // namespace projection_details
+
+template <typename simdjson_value, typename View>
+error_code deserialize_projection(simdjson_value &val, View &out) {
+  using namespace key_table_details;
+  ondemand::object object;
+  auto error = val.get_object().get(object);
+  if (error) { return error; }
+  std::bitset<members<View>.size()> seen;
+  for (auto field : object) {
+    std::string_view key;
+    error = key_of(field, key);
+    if (error) { return error; }
+    const uint8_t index = find<View>(key);
+    if (index == empty_slot) { continue; }
+    ondemand::value value;
+    error = field.value().get(value);
+    if (error) { return error; }
+    error = parsers<View>[index](value, out);
+    if (error) { return error; }
+    seen[index] = true;
+    if (seen.all()) { break; }
+  }
+  if ((required<View> & ~seen).any()) { return NO_SUCH_FIELD; }
+  return SUCCESS;
+}
+
+template <auto... Members, typename simdjson_value, typename T>
+error_code deserialize_fields(simdjson_value &val, T &out) {
+  using wanted = projection_details::fields<T, Members...>;
+  ondemand::object object;
+  auto error = val.get_object().get(object);
+  if (error) { return error; }
+  std::bitset<sizeof...(Members)> seen;
+  for (auto field : object) {
+    std::string_view key;
+    error = key_table_details::key_of(field, key);
+    if (error) { return error; }
+    const size_t index = wanted::find(key);
+    if (index == sizeof...(Members)) { continue; }
+    ondemand::value value;
+    error = field.value().get(value);
+    if (error) { return error; }
+    error = wanted::parsers[index](value, out);
+    if (error) { return error; }
+    seen[index] = true;
+    if (seen.all()) { break; }
+  }
+  if ((wanted::required & ~seen).any()) { return NO_SUCH_FIELD; }
+  return SUCCESS;
+}
+
+} // namespace simdjson
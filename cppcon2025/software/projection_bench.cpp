@@ -0,0 +1,92 @@
+// Partial deserialization of twitter.json: each status carries two dozen
+// keys, among them large user, entities and metadata objects. We request a
+// growing fraction of the members of Status through deserialize_fields()
+// and compare with the full reflection-based get<Status>().
+//
+// Usage: ./projection_bench [twitter.json] [rounds]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "mapped_file.h"
+#include "projection.h"
+#include "twitter_data.h"
+
+// Just what a timeline needs, as a view struct.
+struct StatusSummary {
+  int64_t id;
+  std::string text;
+};
+
+namespace simdjson {
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, StatusSummary &s) {
+  return deserialize_projection(val, s);
+}
+} // namespace simdjson
+
+template <typename F>
+void bench(const char *name, size_t requested, simdjson::padded_string_view json, size_t rounds, F parse) {
+  simdjson::ondemand::parser parser;
+  auto run = [&] {
+    simdjson::ondemand::document doc;
+    if (parser.iterate(json).get(doc)) { std::abort(); }
+    simdjson::ondemand::array statuses;
+    if (doc["statuses"].get_array().get(statuses)) { std::abort(); }
+    for (auto status : statuses) {
+      simdjson::ondemand::value value;
+      if (status.get(value) || parse(value)) { std::abort(); }
+    }
+  };
+  run();
+  double best = 1e300;
+  for (size_t r = 0; r < rounds; r++) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  fmt::print("{:<34} {:>6.0f}% {:>10.3f}\n", name, 100.0 * double(requested) / 13.0, double(json.size()) / best / 1e9);
+}
+
+int main(int argc, char **argv) {
+  const char *path = argc > 1 ? argv[1] : TWITTER_JSON;
+  size_t rounds = argc > 2 ? std::stoul(argv[2]) : 1000;
+  // Parsed in place: no read into a heap buffer, no copy for the padding.
+  simdjson::mapped_file file;
+  if (simdjson::mapped_file::load(path, true).get(file)) {
+    fmt::print(stderr, "could not load {}\n", path);
+    return EXIT_FAILURE;
+  }
+  const simdjson::padded_string_view json = file.view();
+  fmt::print("{:<34} {:>7} {:>10}\n", "statuses", "fields", "GB/s");
+  Status status;
+  bench("id", 1, json, rounds, [&](simdjson::ondemand::value &v) {
+    return simdjson::deserialize_fields<&Status::id>(v, status);
+  });
+  bench("StatusSummary (view struct)", 2, json, rounds, [&](simdjson::ondemand::value &v) {
+    StatusSummary summary;
+    return v.get(summary);
+  });
+  bench("id, text, retweet_count", 3, json, rounds, [&](simdjson::ondemand::value &v) {
+    return simdjson::deserialize_fields<&Status::id, &Status::text, &Status::retweet_count>(v, status);
+  });
+  bench("scalars and strings, no user", 12, json, rounds, [&](simdjson::ondemand::value &v) {
+    return simdjson::deserialize_fields<&Status::created_at, &Status::id, &Status::id_str, &Status::text,
+                                        &Status::source, &Status::truncated, &Status::in_reply_to_user_id,
+                                        &Status::retweet_count, &Status::favorite_count, &Status::favorited,
+                                        &Status::retweeted, &Status::lang>(v, status);
+  });
+  bench("user only", 1, json, rounds, [&](simdjson::ondemand::value &v) {
+    return simdjson::deserialize_fields<&Status::user>(v, status);
+  });
+  bench("all members (get<Status>)", 13, json, rounds, [&](simdjson::ondemand::value &v) {
+    return v.get(status);
+  });
+  return EXIT_SUCCESS;
+}
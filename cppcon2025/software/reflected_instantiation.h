@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <simdjson.h>
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * The reflected serializer and deserializer of a type, compiled once.
+ *
+ * Every translation unit that calls b.append(player) or doc.get(player)
+ * instantiates, and pays the reflection for, the whole member walk of
+ * Player. Going through simdjson::reflected<Player> instead, the work moves
+ * to a single translation unit:
+ *
+ *   // player_json.h, included everywhere
+ *   SIMDJSON_EXTERN_REFLECTED(Player);
+ *
+ *   // player_json.cpp, the only instantiation
+ *   SIMDJSON_INSTANTIATE_REFLECTED(Player);
+ *
+ *   // anywhere
+ *   std::string json = simdjson::reflected<Player>::to_json(p);
+ *   auto error = simdjson::reflected<Player>::from(doc, p);
+ *
+ * The members are defined out of class, hence not inline, so that an
+ * extern template declaration keeps the compiler from instantiating them
+ * even for inlining. Where the declaration is missing, reflected<T> still
+ * works and is instantiated implicitly, as b.append() would be.
+ * The compile_bench target measures the difference (cmake/compile_bench.cmake).
+ */
+namespace simdjson {
+
+template <typename T>
+struct reflected {
+  // b.append(value)
+  static void append(builder::string_builder &b, const T &value);
+  static simdjson_result<std::string> to_json(const T &value);
+  // val.get(out), doc.get(out)
+  static error_code from(ondemand::value &val, T &out);
+  static error_code from(ondemand::document &doc, T &out);
+};
+
+template <typename T>
+void reflected<T>::append(builder::string_builder &b, const T &value) {
+  b.append(value);
+}
+
+template <typename T>
+simdjson_result<std::string> reflected<T>::to_json(const T &value) {
+  builder::string_builder b;
+  append(b, value);
+  std::string_view json;
+  auto error = b.view().get(json);
+  if (error) { return error; }
+  return std::string(json);
+}
+
+template <typename T>
+error_code reflected<T>::from(ondemand::value &val, T &out) {
+  return val.get(out);
+}
+
+template <typename T>
+error_code reflected<T>::from(ondemand::document &doc, T &out) {
+  return doc.get(out);
+}
+
+} // namespace simdjson
+
+// At namespace scope, outside of any namespace.
+#define SIMDJSON_EXTERN_REFLECTED(T) extern template struct simdjson::reflected<T>
+#define SIMDJSON_INSTANTIATE_REFLECTED(T) template struct simdjson::reflected<T>
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <limits>
+#include <meta>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <simdjson.h>
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * Serialization into a caller-owned simdjson::builder::string_builder that is
+ * reused across calls, so that steady-state serialization never allocates:
+ *
+ *   simdjson::builder::string_builder b(simdjson::json_size_bound(car));
+ *   for (const Car &car : cars) {
+ *     std::string_view json = simdjson::to_json_into(car, b); // valid until the next call
+ *   }
+ *
+ * json_size_bound() is an upper bound on the serialized size. Keys,
+ * punctuation and the widest possible numbers are summed at compile time;
+ * only strings and containers add a runtime term (six bytes per character,
+ * the cost of a \u00XX escape). Fixed-shape types, with only numbers, bools,
+ * enums and fixed-shape members, get their bound as a constant:
+ * fixed_json_size_bound<T>().
+ */
+namespace simdjson {
+namespace size_bound_details {
+
+template <typename T>
+concept string_like = std::is_convertible_v<const T &, std::string_view>;
+
+template <typename T>
+concept map_like = requires { typename T::mapped_type; typename T::key_type; };
+
+template <typename T>
+concept range_like = requires(const T &a) {
+  { a.size() } -> std::convertible_to<std::size_t>;
+  a.begin();
+} && !string_like<T>;
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+// The longest shortest-round-trip double: "-2.2250738585072014e-308".
+constexpr size_t max_floating_point_width = 24;
+constexpr size_t null_width = 4;
+
+template <typename T>
+consteval bool is_fixed_shape();
+
+template <typename T>
+consteval size_t fixed_part();
+
+template <typename T>
+consteval bool is_fixed_shape() {
+  if constexpr (std::is_same_v<T, bool> || std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+    return true;
+  } else if constexpr (string_like<T> || range_like<T> || map_like<T>) {
+    return false;
+  } else if constexpr (is_optional<T>::value) {
+    return is_fixed_shape<typename T::value_type>();
+  } else if constexpr (std::is_class_v<T>) {
+    bool fixed = true;
+    template for (constexpr auto member : std::define_static_array(
+                      std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()))) {
+      fixed = fixed && is_fixed_shape<typename[:std::meta::type_of(member):]>();
+    }
+    return fixed;
+  } else {
+    return false;
+  }
+}
+
+// The bytes that do not depend on the value: for a struct, its keys and
+// punctuation plus the fixed part of every member.
+template <typename T>
+consteval size_t fixed_part() {
+  if constexpr (std::is_same_v<T, bool>) {
+    return 5; // false
+  } else if constexpr (std::is_same_v<T, char>) {
+    return 8; // "\u00XX"
+  } else if constexpr (std::is_integral_v<T>) {
+    return std::numeric_limits<T>::digits10 + 1 + std::is_signed_v<T>;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return max_floating_point_width;
+  } else if constexpr (std::is_enum_v<T>) {
+    size_t longest = std::numeric_limits<std::underlying_type_t<T>>::digits10 + 2;
+    template for (constexpr auto e : std::define_static_array(std::meta::enumerators_of(^^T))) {
+      longest = std::max(longest, std::meta::identifier_of(e).size() + 2);
+    }
+    return longest;
+  } else if constexpr (string_like<T>) {
+    return 2; // the quotes
+  } else if constexpr (range_like<T> || map_like<T>) {
+    return 2; // the brackets or braces
+  } else if constexpr (is_optional<T>::value) {
+    return std::max(null_width, fixed_part<typename T::value_type>());
+  } else {
+    constexpr auto members = std::define_static_array(
+        std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()));
+    size_t total = 2 + (members.size() > 0 ? members.size() - 1 : 0); // braces and commas
+    template for (constexpr auto member : members) {
+      total += std::meta::identifier_of(member).size() + 3; // "key":
+      total += fixed_part<typename[:std::meta::type_of(member):]>();
+    }
+    return total;
+  }
+}
+
+template <typename T>
+constexpr size_t runtime_bound(const T &value);
+
+template <typename T>
+constexpr size_t variable_part(const T &value) {
+  if constexpr (is_fixed_shape<T>()) {
+    return 0;
+  } else if constexpr (string_like<T>) {
+    return 6 * std::string_view(value).size();
+  } else if constexpr (map_like<T>) {
+    size_t total = value.size() > 0 ? value.size() - 1 : 0;
+    for (const auto &[key, mapped] : value) {
+      total += runtime_bound(key) + 1 + runtime_bound(mapped);
+    }
+    return total;
+  } else if constexpr (range_like<T>) {
+    using element_type = std::remove_cvref_t<decltype(*value.begin())>;
+    size_t total = value.size() > 0 ? value.size() - 1 : 0;
+    if constexpr (is_fixed_shape<element_type>()) {
+      total += value.size() * fixed_part<element_type>();
+    } else {
+      for (const auto &element : value) { total += runtime_bound(element); }
+    }
+    return total;
+  } else if constexpr (is_optional<T>::value) {
+    return value ? variable_part(*value) : 0;
+  } else {
+    size_t total = 0;
+    template for (constexpr auto member : std::define_static_array(
+                      std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()))) {
+      total += variable_part(value.[:member:]);
+    }
+    return total;
+  }
+}
+
+template <typename T>
+constexpr size_t runtime_bound(const T &value) {
+  return fixed_part<T>() + variable_part(value);
+}
+
+} // namespace size_bound_details
+
+template <typename T>
+concept fixed_shape = size_bound_details::is_fixed_shape<T>();
+
+template <fixed_shape T>
+consteval size_t fixed_json_size_bound() {
+  return size_bound_details::fixed_part<T>();
+}
+
+template <typename T>
+constexpr size_t json_size_bound(const T &value) {
+  return size_bound_details::runtime_bound(value);
+}
+
+/**
+ * Serializes value into b, replacing what b held: the buffer of b is kept,
+ * so once b is large enough nothing is allocated. The view is valid until b
+ * is modified.
+ */
+template <typename T>
+simdjson_result<std::string_view> to_json_into(const T &value, builder::string_builder &b) {
+  b.clear();
+  b.append(value);
+  return b.view();
+}
+
+} // namespace simdjson
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#if __has_include(<flat_map>)
+#include <flat_map>
+#endif
+#include <simdjson.h>
+
+#include "json_escape.h"
+#include "key_table.h"
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * Objects keyed by arbitrary strings (leaderboards: "alice": {...}, for
+ * 100k players) as hash maps, without the per-key costs of std::map:
+ *
+ *   struct GameData {
+ *     simdjson::string_map<Player> players;
+ *   };
+ *   auto p = data.players.find(std::string_view("alice")); // no temporary std::string
+ *
+ * Deserialization counts the fields first and reserves, so the table never
+ * rehashes. Keys without escapes (nearly all of them) are taken from the
+ * input as they are, without going through the unescaping buffer. With
+ * string_view_map the key is not even copied: it views the input, or the
+ * parser's string buffer for the rare escaped key, and is valid as long as
+ * both are (hold them in a document_handle). string_flat_map, where
+ * <flat_map> is available, collects keys and values in two vectors and
+ * sorts them once. Duplicate keys: the last one wins, except in
+ * string_flat_map where one of them is kept.
+ *
+ * Serialization writes each key that needs no escaping with one bulk copy;
+ * append_map() works for any map with string keys, std::map included.
+ */
+namespace simdjson {
+
+// Transparent: find(), count() and contains() take a std::string_view.
+struct string_hash {
+  using is_transparent = void;
+  size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+
+template <typename V>
+using string_map = std::unordered_map<std::string, V, string_hash, std::equal_to<>>;
+
+template <typename V>
+using string_view_map = std::unordered_map<std::string_view, V, string_hash, std::equal_to<>>;
+
+#if defined(__cpp_lib_flat_map)
+template <typename V>
+using string_flat_map = std::flat_map<std::string, V, std::less<>>;
+#endif
+
+namespace string_map_details {
+
+template <typename simdjson_value, typename Map>
+error_code deserialize_hashed(simdjson_value &val, Map &out) {
+  ondemand::object object;
+  auto error = val.get_object().get(object);
+  if (error) { return error; }
+  size_t count;
+  error = object.count_fields().get(count);
+  if (error) { return error; }
+  out.clear();
+  out.reserve(count);
+  for (auto field : object) {
+    std::string_view key;
+    error = key_table_details::key_of(field, key);
+    if (error) { return error; }
+    ondemand::value value;
+    error = field.value().get(value);
+    if (error) { return error; }
+    // A fresh value each time: a repeated key replaces the earlier value
+    // instead of being parsed into it.
+    typename Map::mapped_type parsed{};
+    error = value.get(parsed);
+    if (error) { return error; }
+    out.insert_or_assign(typename Map::key_type(key), std::move(parsed));
+  }
+  return SUCCESS;
+}
+
+inline bool needs_escaping(std::string_view key) {
+  return std::any_of(key.begin(), key.end(),
+                     [](char c) { return json_escape::needs_escape(static_cast<unsigned char>(c)); });
+}
+
+} // namespace string_map_details
+
+template <typename simdjson_value, typename V, typename A>
+error_code tag_invoke(deserialize_tag, simdjson_value &val,
+                      std::unordered_map<std::string, V, string_hash, std::equal_to<>, A> &out) {
+  return string_map_details::deserialize_hashed(val, out);
+}
+
+template <typename simdjson_value, typename V, typename A>
+error_code tag_invoke(deserialize_tag, simdjson_value &val,
+                      std::unordered_map<std::string_view, V, string_hash, std::equal_to<>, A> &out) {
+  return string_map_details::deserialize_hashed(val, out);
+}
+
+#if defined(__cpp_lib_flat_map)
+template <typename simdjson_value, typename V>
+error_code tag_invoke(deserialize_tag, simdjson_value &val, string_flat_map<V> &out) {
+  ondemand::object object;
+  auto error = val.get_object().get(object);
+  if (error) { return error; }
+  size_t count;
+  error = object.count_fields().get(count);
+  if (error) { return error; }
+  std::vector<std::string> keys;
+  std::vector<V> values;
+  keys.reserve(count);
+  values.reserve(count);
+  for (auto field : object) {
+    std::string_view key;
+    error = key_table_details::key_of(field, key);
+    if (error) { return error; }
+    ondemand::value value;
+    error = field.value().get(value);
+    if (error) { return error; }
+    keys.emplace_back(key);
+    error = value.get(values.emplace_back());
+    if (error) { return error; }
+  }
+  // One sort for the whole object rather than a shifting insert per key.
+  out = string_flat_map<V>(std::move(keys), std::move(values));
+  return SUCCESS;
+}
+#endif
+
+// {"key":value,...}, values through the builder.
+template <typename Map>
+void append_map(builder::string_builder &b, const Map &map) {
+  thread_local std::string escaped;
+  b.append('{');
+  bool first = true;
+  for (const auto &[key, value] : map) {
+    if (!first) { b.append(','); }
+    first = false;
+    const std::string_view name(key);
+    b.append('"');
+    if (string_map_details::needs_escaping(name)) {
+      escaped.clear();
+      json_escape::escape_to(escaped, name);
+      b.append_raw(escaped);
+    } else {
+      b.append_raw(name);
+    }
+    b.append_raw("\":");
+    b.append(value);
+  }
+  b.append('}');
+}
+
+template <typename V, typename A>
+void tag_invoke(serialize_tag, builder::string_builder &b,
+                const std::unordered_map<std::string, V, string_hash, std::equal_to<>, A> &map) {
+  append_map(b, map);
+}
+
+template <typename V, typename A>
+void tag_invoke(serialize_tag, builder::string_builder &b,
+                const std::unordered_map<std::string_view, V, string_hash, std::equal_to<>, A> &map) {
+  append_map(b, map);
+}
+
+#if defined(__cpp_lib_flat_map)
+template <typename V>
+void tag_invoke(serialize_tag, builder::string_builder &b, const string_flat_map<V> &map) {
+  append_map(b, map);
+}
+#endif
+
+} // namespace simdjson
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A counter that many threads can bump without sharing a cache line: each
+ * thread adds to one of a few stripes (picked once per thread), total()
+ * sums them. Increments are relaxed, so totals are a snapshot that may miss
+ * increments still in flight.
+ */
+class striped_counter {
+public:
+    static constexpr size_t stripes = 16;
+
+    void add(uint64_t n = 1) {
+        stripe[stripe_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t total() const {
+        uint64_t sum = 0;
+        for (const auto &s : stripe) { sum += s.value.load(std::memory_order_relaxed); }
+        return sum;
+    }
+
+    void reset() {
+        for (auto &s : stripe) { s.value.store(0, std::memory_order_relaxed); }
+    }
+
+private:
+    static size_t stripe_index() {
+        static std::atomic<size_t> next_thread{0};
+        thread_local const size_t index = next_thread.fetch_add(1, std::memory_order_relaxed) % stripes;
+        return index;
+    }
+
+    struct alignas(64) padded_value {
+        std::atomic<uint64_t> value{0};
+    };
+    padded_value stripe[stripes];
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <concepts>
+#include <meta>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <simdjson.h>
+
+#include "json_escape.h"
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+/**
+ * Build a struct from another struct, member by member, matching on member
+ * names. This lets you parse a JSON object once into one struct and derive
+ * the others from it: members of the same type are moved (a float column is
+ * materialized exactly once), the others are converted element-wise.
+ *
+ *   weather_data wd = doc["hourly"].get<weather_data>();
+ *   auto cwd = simdjson::project<complicated_weather_data>(std::move(wd));
+ *
+ * A std::string (or std::string_view) projected onto a class type that is
+ * not a string, such as MyDate, goes through that type's deserializer: the
+ * string is written back as a JSON string and parsed, so that project<>()
+ * gives the value get<>() would have. Other types are assigned when they
+ * can be. The error is that of the deserializer. The JSON is a scratch
+ * buffer: project onto types that own their data (MyDate, not MyDateView).
+ */
+namespace simdjson {
+namespace projection_details {
+
+template <typename T>
+concept sized_range = requires(T a) {
+  { a.size() } -> std::convertible_to<std::size_t>;
+  a.begin();
+  a.end();
+} && !std::is_convertible_v<T, std::string_view>;
+
+template <typename T>
+concept standard_string = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+template <typename To>
+error_code deserialize_string(To &to, std::string_view from) {
+  thread_local std::string json;
+  thread_local ondemand::parser parser;
+  json.clear();
+  json += '"';
+  json_escape::escape_to(json, from);
+  json += '"';
+  json.reserve(json.size() + SIMDJSON_PADDING);
+  ondemand::document doc;
+  auto error = parser.iterate(padded_string_view(json.data(), json.size(), json.capacity())).get(doc);
+  if (error) { return error; }
+  return doc.get(to);
+}
+
+template <typename To, typename From>
+error_code project_member(To &to, From &&from) {
+  using from_type = std::remove_cvref_t<From>;
+  if constexpr (std::is_same_v<To, from_type>) {
+    to = std::forward<From>(from);
+  } else if constexpr (standard_string<from_type> && std::is_class_v<To> && !standard_string<To>) {
+    // Custom types such as MyDate.
+    return deserialize_string(to, std::string_view(from));
+  } else if constexpr (std::is_assignable_v<To &, From>) {
+    to = std::forward<From>(from);
+  } else if constexpr (sized_range<To> && sized_range<from_type>) {
+    to.clear();
+    if constexpr (requires { to.reserve(from.size()); }) {
+      to.reserve(from.size());
+    }
+    for (auto &element : from) {
+      typename To::value_type converted{};
+      auto error = project_member(converted, std::move(element));
+      if (error) { return error; }
+      to.push_back(std::move(converted));
+    }
+  } else {
+    static_assert(!sizeof(To), "simdjson::project: no conversion between these member types");
+  }
+  return SUCCESS;
+}
+
+} // namespace projection_details
+
+template <typename To, typename From>
+  requires std::is_class_v<std::remove_cvref_t<From>>
+simdjson_result<To> project(From &&from) {
+  using from_type = std::remove_cvref_t<From>;
+  To out{};
+  error_code error = SUCCESS;
+  template for (constexpr auto to_member : std::define_static_array(
+                    std::meta::nonstatic_data_members_of(^^To, std::meta::access_context::unchecked()))) {
+    constexpr std::string_view name = std::meta::identifier_of(to_member);
+    template for (constexpr auto from_member : std::define_static_array(
+                      std::meta::nonstatic_data_members_of(^^from_type, std::meta::access_context::unchecked()))) {
+      if constexpr (std::meta::identifier_of(from_member) == name) {
+        if (!error) {
+          if constexpr (std::is_lvalue_reference_v<From>) {
+            error = projection_details::project_member(out.[:to_member:], from.[:from_member:]);
+          } else {
+            error = projection_details::project_member(out.[:to_member:], std::move(from.[:from_member:]));
+          }
+        }
+      }
+    }
+  }
+  if (error) { return error; }
+  return out;
+}
+
+} // namespace simdjson
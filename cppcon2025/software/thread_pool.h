@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads running parallel_for() jobs. Tasks are
+ * claimed one at a time from a shared counter, so uneven tasks balance
+ * themselves. parallel_for() blocks until every task is done and rethrows
+ * the first exception a task threw.
+ */
+class thread_pool {
+public:
+    explicit thread_pool(size_t count) {
+        workers.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        job_ready.notify_all();
+        for (auto &worker : workers) { worker.join(); }
+    }
+
+    size_t size() const { return workers.size(); }
+
+    void parallel_for(size_t tasks, const std::function<void(size_t)> &task) {
+        if (tasks == 0) { return; }
+        if (workers.empty()) {
+            for (size_t i = 0; i < tasks; i++) { task(i); }
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        job = &task;
+        job_tasks = tasks;
+        next_task.store(0, std::memory_order_relaxed);
+        busy_workers = workers.size();
+        failure = nullptr;
+        generation++;
+        job_ready.notify_all();
+        job_done.wait(lock, [this] { return busy_workers == 0; });
+        job = nullptr;
+        if (failure) { std::rethrow_exception(failure); }
+    }
+
+private:
+    void work() {
+        size_t seen_generation = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_ready.wait(lock, [&] { return stopping || generation != seen_generation; });
+            if (stopping) { return; }
+            seen_generation = generation;
+            const std::function<void(size_t)> *task = job;
+            const size_t tasks = job_tasks;
+            lock.unlock();
+            for (size_t i = next_task.fetch_add(1); i < tasks; i = next_task.fetch_add(1)) {
+                try {
+                    (*task)(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    if (!failure) { failure = std::current_exception(); }
+                }
+            }
+            lock.lock();
+            if (--busy_workers == 0) { job_done.notify_one(); }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    const std::function<void(size_t)> *job{nullptr};
+    size_t job_tasks{0};
+    std::atomic<size_t> next_task{0};
+    size_t busy_workers{0};
+    size_t generation{0};
+    bool stopping{false};
+    std::exception_ptr failure;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// The parts of twitter.json (cppcon2025/go/twitter.json) the benchmarks use.
+struct User {
+  int64_t id;
+  std::string screen_name;
+  std::string name;
+  int64_t followers_count;
+  int64_t friends_count;
+};
+
+// Thirteen of the twenty-three keys of a status, in document order.
+struct Status {
+  std::string created_at;
+  int64_t id;
+  std::string id_str;
+  std::string text;
+  std::string source;
+  bool truncated;
+  std::optional<int64_t> in_reply_to_user_id;
+  User user;
+  int64_t retweet_count;
+  int64_t favorite_count;
+  bool favorited;
+  bool retweeted;
+  std::string lang;
+};
+
+struct TwitterFeed {
+  std::vector<Status> statuses;
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <curl/curl.h>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "instrumentation.h"
+#include "json_stream.h"
+#include "padded_buffer.h"
+
+// Used when the server does not send a Content-Length (e.g., chunked encoding).
+constexpr size_t default_response_capacity = 64 * 1024;
+
+constexpr std::string_view open_meteo_url = "https://api.open-meteo.com/v1/forecast";
+
+// Appends the hourly forecast URL for a location to out.
+inline void forecast_url(std::string &out, std::string_view base_url, std::string_view latitude, std::string_view longitude) {
+    fmt::format_to(std::back_inserter(out), "{}?latitude={}&longitude={}&hourly=temperature_2m,relative_humidity_2m,winddirection_10m,precipitation,windspeed_10m", base_url, latitude, longitude);
+}
+
+/**
+ * Everything one request needs, kept alive between requests: the curl easy
+ * handle (and therefore its connection and TLS session), the padded response
+ * buffer and the simdjson parser. Once warmed up, a request only reuses
+ * memory that is already allocated.
+ */
+class weather_client {
+public:
+    explicit weather_client(std::string_view base = open_meteo_url) : base_url(base) {
+        curl = curl_easy_init();
+        if (!curl) {
+            throw std::runtime_error("Could not initialize cURL");
+        }
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, +[](char *ptr, size_t size, size_t nmemb, void *userdata) -> size_t {
+            auto *client = static_cast<weather_client*>(userdata);
+            if (!client->sized) {
+                // The headers are in by the time the first chunk arrives: size the
+                // buffer once from Content-Length so that it never reallocates.
+                curl_off_t content_length = -1;
+                curl_easy_getinfo(client->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &content_length);
+                client->response_data.reserve(content_length > 0 ? size_t(content_length) : default_response_capacity);
+                client->sized = true;
+            }
+            client->response_data.append(ptr, size * nmemb);
+            return size * nmemb;
+        });
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+    }
+    weather_client(const weather_client&) = delete;
+    weather_client& operator=(const weather_client&) = delete;
+    ~weather_client() { curl_easy_cleanup(curl); }
+
+    // The returned view is valid until the next call.
+    simdjson::padded_string_view grab_weather_data(std::string_view latitude, std::string_view longitude) {
+        url.clear();
+        forecast_url(url, base_url, latitude, longitude);
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        response_data.clear();
+        sized = false;
+        CURLcode res = curl_easy_perform(curl);
+        if (res != CURLE_OK) {
+            throw std::runtime_error("Request failed cURL: " + std::string(curl_easy_strerror(res)));
+        }
+        return response_data.view();
+    }
+
+    // Hands the last response over to the caller, e.g., to a document_handle.
+    // The next request starts with an empty buffer.
+    padded_buffer release_response() {
+        return std::exchange(response_data, padded_buffer{});
+    }
+
+    // POSTs value as JSON, streamed in chunks while it is serialized: no
+    // copy of the whole document is ever made. The response is returned
+    // like grab_weather_data()'s, and is valid until the next call.
+    template <typename T>
+    simdjson::padded_string_view post_json(std::string_view target, const T &value) {
+        url.assign(target);
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        response_data.clear();
+        sized = false;
+        simdjson::curl_upload upload;
+        upload.attach(curl);
+        std::thread producer([&upload, &value] { upload.produce(value); });
+        CURLcode res = curl_easy_perform(curl);
+        // If curl stopped reading early, the producer must not wait forever.
+        upload.cancel();
+        producer.join();
+        simdjson::curl_upload::detach(curl);
+        if (res != CURLE_OK) {
+            throw std::runtime_error("Upload failed cURL: " + std::string(curl_easy_strerror(res)));
+        }
+        return response_data.view();
+    }
+
+    // The returned document is valid until the next call.
+    simdjson::ondemand::document iterate(std::string_view latitude, std::string_view longitude) {
+        simdjson::padded_string_view json = grab_weather_data(latitude, longitude);
+        instrumentation::add(instrumentation::bytes_indexed, json.size());
+        return parser.iterate(json);
+    }
+
+private:
+    CURL *curl;
+    std::string base_url;
+    std::string url;
+    padded_buffer response_data;
+    bool sized{false};
+    simdjson::ondemand::parser parser;
+};
+
+/**
+ * A fixed set of weather_client instances shared by many threads. acquire()
+ * blocks until a client is free; the lease hands it back when it goes out of
+ * scope. curl_global_init() must have been called before threads start.
+ */
+class client_pool {
+public:
+    class lease {
+    public:
+        lease(client_pool &p, std::unique_ptr<weather_client> c) : pool(&p), client(std::move(c)) {}
+        lease(lease &&other) noexcept = default;
+        lease& operator=(lease &&other) = delete;
+        ~lease() { if (client) { pool->release(std::move(client)); } }
+        weather_client *operator->() { return client.get(); }
+        weather_client &operator*() { return *client; }
+    private:
+        client_pool *pool;
+        std::unique_ptr<weather_client> client;
+    };
+
+    explicit client_pool(size_t count, std::string_view base_url = open_meteo_url) {
+        clients.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            clients.push_back(std::make_unique<weather_client>(base_url));
+        }
+    }
+
+    lease acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        available.wait(lock, [this] { return !clients.empty(); });
+        std::unique_ptr<weather_client> client = std::move(clients.back());
+        clients.pop_back();
+        return lease(*this, std::move(client));
+    }
+
+private:
+    void release(std::unique_ptr<weather_client> client) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // Never reallocates: the capacity was reserved for every client.
+            clients.push_back(std::move(client));
+        }
+        available.notify_one();
+    }
+
+    std::mutex mutex;
+    std::condition_variable available;
+    std::vector<std::unique_ptr<weather_client>> clients;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <simdjson.h>
+
+#if !SIMDJSON_STATIC_REFLECTION
+#error "You need to enable static reflection for this to work"
+#endif
+
+#include "column_deserialize.h"
+#include "float_format.h"
+#include "key_table.h"
+
+
+// The precisions are those of the API, for to_json_formatted().
+struct weather_data {
+    std::vector<std::string> time;
+    [[=simdjson::precision{1}]] std::vector<float> temperature_2m;
+    [[=simdjson::precision{0}]] std::vector<float> relative_humidity_2m;
+    [[=simdjson::precision{0}]] std::vector<float> winddirection_10m;
+    [[=simdjson::precision{1}]] std::vector<float> precipitation;
+    [[=simdjson::precision{1}]] std::vector<float> windspeed_10m;
+};
+
+
+/**
+ * Next we check that we can combine custom types with static reflection.
+ */
+
+
+class MyDate {
+public:
+    void assign(std::string_view str) {
+        date_str = str;
+    }
+    const std::string& to_string() const {
+        return date_str;
+    }
+private:
+    std::string date_str;
+};
+
+namespace simdjson {
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, MyDate& date) {
+    std::string_view str;
+    auto error = val.get_string().get(str);
+    if(error) { return error; }
+    date.assign(str);
+  return simdjson::SUCCESS;
+}
+} // namespace simdjson
+
+struct complicated_weather_data {
+    std::vector<MyDate> time;
+    std::vector<float> temperature_2m;
+    std::vector<float> relative_humidity_2m;
+    std::vector<float> winddirection_10m;
+    std::vector<float> precipitation;
+    std::vector<float> windspeed_10m;
+};
+
+
+/**
+ * Zero-copy variant of MyDate: it views the timestamp instead of owning it,
+ * so it must live inside a simdjson::document_handle.
+ */
+class MyDateView {
+public:
+    void assign(std::string_view str) {
+        date_str = str;
+    }
+    std::string_view to_string() const {
+        return date_str;
+    }
+private:
+    std::string_view date_str;
+};
+
+namespace simdjson {
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, MyDateView& date) {
+    // Timestamps never need unescaping: point straight into the input.
+    std::string_view token;
+    auto error = val.raw_json_token().get(token);
+    if(error) { return error; }
+    size_t closing_quote = token.rfind('"');
+    if (token.size() >= 2 && token[0] == '"' && closing_quote > 0) {
+        std::string_view raw = token.substr(1, closing_quote - 1);
+        if (raw.find('\\') == std::string_view::npos) {
+            date.assign(raw);
+            return simdjson::SUCCESS;
+        }
+    }
+    // Escaped strings are unescaped into the parser's string buffer, which
+    // the document_handle also owns.
+    std::string_view str;
+    error = val.get_string().get(str);
+    if(error) { return error; }
+    date.assign(str);
+  return simdjson::SUCCESS;
+}
+} // namespace simdjson
+
+struct weather_data_view {
+    std::vector<MyDateView> time;
+    std::vector<float> temperature_2m;
+    std::vector<float> relative_humidity_2m;
+    std::vector<float> winddirection_10m;
+    std::vector<float> precipitation;
+    std::vector<float> windspeed_10m;
+};
+
+// The time column as sortable integers, see epoch_minutes_column.
+struct indexed_weather_data {
+    epoch_minutes_column time;
+    std::vector<float> temperature_2m;
+    std::vector<float> relative_humidity_2m;
+    std::vector<float> winddirection_10m;
+    std::vector<float> precipitation;
+    std::vector<float> windspeed_10m;
+};
+
+/**
+ * The hourly structs opt in to key_table.h: keys are matched in the order
+ * the API sends them, and the float columns go through
+ * deserialize_column().
+ */
+namespace simdjson {
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, weather_data &wd) {
+    return deserialize_in_order(val, wd);
+}
+
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, complicated_weather_data &cwd) {
+    return deserialize_in_order(val, cwd);
+}
+
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, weather_data_view &wd) {
+    return deserialize_in_order(val, wd);
+}
+
+template <typename simdjson_value>
+auto tag_invoke(deserialize_tag, simdjson_value &val, indexed_weather_data &wd) {
+    return deserialize_in_order(val, wd);
+}
+} // namespace simdjson
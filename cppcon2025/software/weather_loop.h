@@ -0,0 +1,276 @@
+#pragma once
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <curl/curl.h>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "instrumentation.h"
+#include "padded_buffer.h"
+#include "weather_client.h"
+
+/**
+ * Forecasts fetched by coroutines over one curl multi handle, driven by
+ * epoll: hundreds of requests in flight on one thread instead of one
+ * thread per request blocked in curl_easy_perform for the whole round
+ * trip.
+ *
+ *   weather_loop loop;
+ *   detached forecast(weather_loop &loop, std::string lat, std::string lon) {
+ *       weather_loop::response reply = co_await loop.fetch(lat, lon);
+ *       if (reply.error() != CURLE_OK) { co_return; }
+ *       simdjson::ondemand::document doc;
+ *       weather_data wd;
+ *       if (loop.iterate(reply).get(doc) || doc["hourly"].get(wd)) { co_return; }
+ *       ...
+ *   }
+ *   for (...) { forecast(loop, lat, lon); } // each runs up to its fetch
+ *   loop.run();                             // until every transfer is done
+ *
+ * A coroutine resumes on the thread calling run(), and parsing never
+ * suspends, so one loop needs a single simdjson parser: a response goes
+ * straight from its buffer into loop.iterate(). For more cores, run one
+ * loop per thread. Transfers (easy handle, padded response buffer) are
+ * pooled like weather_client instances, and connections stay in the multi
+ * handle's cache: a warmed-up loop only reuses memory.
+ *
+ * A loop is not thread-safe, and the document returned by iterate() is
+ * valid until the next call, as with weather_client. A detached coroutine
+ * terminates the process if an exception escapes it: iterate() returns a
+ * simdjson_result to check, and an HTTP error status fails the transfer
+ * (CURLOPT_FAILONERROR) rather than handing over an error page.
+ */
+
+// A coroutine started eagerly and never awaited: it owns its frame, which
+// is freed when it returns. It must not let an exception escape.
+struct detached {
+    struct promise_type {
+        detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+class weather_loop {
+    struct transfer {
+        CURL *curl{nullptr};
+        std::string url;
+        padded_buffer body;
+        bool sized{false};
+        CURLcode result{CURLE_OK};
+        std::coroutine_handle<> waiter;
+    };
+
+public:
+    // A completed transfer. Hands its handle and buffer back to the loop
+    // when it goes out of scope.
+    class response {
+    public:
+        response(weather_loop &l, transfer *t) : loop(&l), current(t) {}
+        response(response &&other) noexcept : loop(other.loop), current(std::exchange(other.current, nullptr)) {}
+        response& operator=(response &&other) = delete;
+        ~response() { if (current) { loop->idle.emplace_back(current); } }
+        CURLcode error() const { return current->result; }
+        simdjson::padded_string_view view() { return current->body.view(); }
+    private:
+        weather_loop *loop;
+        transfer *current;
+    };
+
+    class fetch_awaiter {
+    public:
+        fetch_awaiter(weather_loop &l, transfer *t) : loop(&l), current(t) {}
+        bool await_ready() const noexcept { return false; }
+        // Does not suspend if the transfer could not even start.
+        bool await_suspend(std::coroutine_handle<> h) {
+            current->waiter = h;
+            return loop->start(current);
+        }
+        response await_resume() { return response(*loop, current); }
+    private:
+        weather_loop *loop;
+        transfer *current;
+    };
+
+    explicit weather_loop(std::string_view base = open_meteo_url) : base_url(base) {
+        multi = curl_multi_init();
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (!multi || epoll_fd < 0) {
+            throw std::runtime_error("Could not initialize the cURL multi handle");
+        }
+        curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, +[](CURL *, curl_socket_t s, int what, void *userp, void *) -> int {
+            static_cast<weather_loop*>(userp)->watch(s, what);
+            return 0;
+        });
+        curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this);
+        curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, +[](CURLM *, long timeout_ms, void *userp) -> int {
+            auto *loop = static_cast<weather_loop*>(userp);
+            loop->has_deadline = timeout_ms >= 0;
+            loop->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+            return 0;
+        });
+        curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this);
+    }
+    weather_loop(const weather_loop&) = delete;
+    weather_loop& operator=(const weather_loop&) = delete;
+    ~weather_loop() {
+        for (auto &t : transfers) {
+            curl_multi_remove_handle(multi, t->curl);
+            curl_easy_cleanup(t->curl);
+        }
+        curl_multi_cleanup(multi);
+        close(epoll_fd);
+    }
+
+    // co_await loop.fetch(latitude, longitude) suspends until the forecast
+    // is in, and yields a response.
+    fetch_awaiter fetch(std::string_view latitude, std::string_view longitude) {
+        transfer *t = acquire();
+        t->url.clear();
+        forecast_url(t->url, base_url, latitude, longitude);
+        return fetch_awaiter(*this, t);
+    }
+
+    // The returned document is valid until the next call.
+    simdjson::simdjson_result<simdjson::ondemand::document> iterate(response &reply) {
+        simdjson::padded_string_view json = reply.view();
+        instrumentation::add(instrumentation::bytes_indexed, json.size());
+        return json_parser.iterate(json);
+    }
+
+    size_t in_flight() const { return running; }
+
+    // Drives the transfers, resuming each coroutine as its transfer
+    // completes, until none is left.
+    void run() {
+        std::vector<epoll_event> events(64);
+        std::vector<transfer*> done;
+        while (running > 0) {
+            int wait_ms = -1;
+            if (has_deadline) {
+                auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                wait_ms = remaining.count() > 0 ? int(remaining.count()) : 0;
+            }
+            int ready = epoll_wait(epoll_fd, events.data(), int(events.size()), wait_ms);
+            if (ready < 0 && errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "epoll_wait");
+            }
+            int still_running = 0;
+            for (int i = 0; i < ready; i++) {
+                int flags = 0;
+                if (events[i].events & EPOLLIN) { flags |= CURL_CSELECT_IN; }
+                if (events[i].events & EPOLLOUT) { flags |= CURL_CSELECT_OUT; }
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) { flags |= CURL_CSELECT_ERR; }
+                curl_multi_socket_action(multi, events[i].data.fd, flags, &still_running);
+            }
+            if (has_deadline && std::chrono::steady_clock::now() >= deadline) {
+                has_deadline = false;
+                curl_multi_socket_action(multi, CURL_SOCKET_TIMEOUT, 0, &still_running);
+            }
+            // Collected first: a resumed coroutine may start another transfer.
+            done.clear();
+            int queued;
+            while (CURLMsg *message = curl_multi_info_read(multi, &queued)) {
+                if (message->msg != CURLMSG_DONE) { continue; }
+                char *owner = nullptr;
+                curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &owner);
+                auto *t = reinterpret_cast<transfer*>(owner);
+                t->result = message->data.result;
+                curl_multi_remove_handle(multi, t->curl);
+                done.push_back(t);
+            }
+            for (transfer *t : done) {
+                running--;
+                std::exchange(t->waiter, nullptr).resume();
+            }
+        }
+    }
+
+private:
+    transfer *acquire() {
+        if (!idle.empty()) {
+            transfer *t = idle.back();
+            idle.pop_back();
+            return t;
+        }
+        auto t = std::make_unique<transfer>();
+        t->curl = curl_easy_init();
+        if (!t->curl) {
+            throw std::runtime_error("Could not initialize cURL");
+        }
+        curl_easy_setopt(t->curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(t->curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(t->curl, CURLOPT_PRIVATE, t.get());
+        curl_easy_setopt(t->curl, CURLOPT_WRITEFUNCTION, +[](char *ptr, size_t size, size_t nmemb, void *userdata) -> size_t {
+            auto *t = static_cast<transfer*>(userdata);
+            if (!t->sized) {
+                // As in weather_client: size the buffer once, from Content-Length.
+                curl_off_t content_length = -1;
+                curl_easy_getinfo(t->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &content_length);
+                t->body.reserve(content_length > 0 ? size_t(content_length) : default_response_capacity);
+                t->sized = true;
+            }
+            t->body.append(ptr, size * nmemb);
+            return size * nmemb;
+        });
+        curl_easy_setopt(t->curl, CURLOPT_WRITEDATA, t.get());
+        transfers.push_back(std::move(t));
+        // Never reallocates once every transfer has been created.
+        idle.reserve(transfers.size());
+        return transfers.back().get();
+    }
+
+    bool start(transfer *t) {
+        curl_easy_setopt(t->curl, CURLOPT_URL, t->url.c_str());
+        t->body.clear();
+        t->sized = false;
+        if (curl_multi_add_handle(multi, t->curl) != CURLM_OK) {
+            t->result = CURLE_FAILED_INIT;
+            return false;
+        }
+        running++;
+        return true;
+    }
+
+    void watch(curl_socket_t s, int what) {
+        if (what == CURL_POLL_REMOVE) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, s, nullptr);
+            return;
+        }
+        epoll_event event{};
+        event.data.fd = s;
+        if (what & CURL_POLL_IN) { event.events |= EPOLLIN; }
+        if (what & CURL_POLL_OUT) { event.events |= EPOLLOUT; }
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, s, &event) != 0 && errno == ENOENT) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, s, &event);
+        }
+    }
+
+    CURLM *multi;
+    int epoll_fd;
+    std::string base_url;
+    bool has_deadline{false};
+    std::chrono::steady_clock::time_point deadline;
+    size_t running{0};
+    std::vector<std::unique_ptr<transfer>> transfers;
+    std::vector<transfer*> idle;
+    simdjson::ondemand::parser json_parser;
+};
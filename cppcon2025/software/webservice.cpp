@@ -1,91 +1,40 @@
-#include <string>
-#include <vector>
 #include <curl/curl.h>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <simdjson.h>
 
-#if !SIMDJSON_STATIC_REFLECTION
-#error "You need to enable static reflection for this to work"
-#endif
+#include "document_handle.h"
+#include "instrumentation.h"
+#include "struct_projection.h"
+#include "weather_client.h"
+#include "weather_data.h"
+#include "weather_loop.h"
 
 
-struct weather_data {
-    std::vector<std::string> time;
-    std::vector<float> temperature_2m;
-    std::vector<float> relative_humidity_2m;
-    std::vector<float> winddirection_10m;
-    std::vector<float> precipitation;
-    std::vector<float> windspeed_10m;
-};
-
-std::string grab_weather_data(const std::string& latitude, const std::string& longitude) {
-    std::string url = fmt::format("https://api.open-meteo.com/v1/forecast?latitude={}&longitude={}&hourly=temperature_2m,relative_humidity_2m,winddirection_10m,precipitation,windspeed_10m", latitude, longitude);
-    CURL *curl = curl_easy_init();
-    if (!curl) {
-        throw std::runtime_error("Could not initialize cURL");
+// Fetched concurrently with the others on the same loop; parsed as soon as
+// it is in.
+detached city_forecast(weather_loop &loop, std::string_view city, std::string_view latitude, std::string_view longitude) {
+    weather_loop::response reply = co_await loop.fetch(latitude, longitude);
+    if (reply.error() != CURLE_OK) {
+        fmt::print("{}: {}\n", city, curl_easy_strerror(reply.error()));
+        co_return;
     }
-    std::string response_data;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, +[](char *ptr, size_t size, size_t nmemb, void *userdata) -> size_t {
-        auto *str = static_cast<std::string*>(userdata);
-        str->append(ptr, size * nmemb);
-        return size * nmemb;
-    });
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);
-    CURLcode res = curl_easy_perform(curl);
-    if (res != CURLE_OK) {
-        curl_easy_cleanup(curl);
-        throw std::runtime_error("Request failed cURL: " + std::string(curl_easy_strerror(res)));
+    simdjson::ondemand::document doc;
+    weather_data wd;
+    if (loop.iterate(reply).get(doc) || doc["hourly"].get(wd) || wd.temperature_2m.empty()) {
+        fmt::print("{}: unexpected forecast\n", city);
+        co_return;
     }
-    curl_easy_cleanup(curl);
-    return response_data;
+    fmt::print("{}: {} hours, first {:.1f}°C\n", city, wd.time.size(), wd.temperature_2m[0]);
 }
 
-
-/**
- * Next we check that we can combine custom types with static reflection.
- */
-
-
-class MyDate {
-public:
-    void assign(std::string_view str) {
-        date_str = str;
-    }
-    const std::string& to_string() const {
-        return date_str;
-    }
-private:
-    std::string date_str;
-};
-
-namespace simdjson {
-template <typename simdjson_value>
-auto tag_invoke(deserialize_tag, simdjson_value &val, MyDate& date) {
-    std::string_view str;
-    auto error = val.get_string().get(str);
-    if(error) { return error; }
-    date.assign(str);
-  return simdjson::SUCCESS;
-}
-} // namespace simdjson
-
-struct complicated_weather_data {
-    std::vector<MyDate> time;
-    std::vector<float> temperature_2m;
-    std::vector<float> relative_humidity_2m;
-    std::vector<float> winddirection_10m;
-    std::vector<float> precipitation;
-    std::vector<float> windspeed_10m;
-};
-
-
-int main() {
-    std::string weather_data_str = grab_weather_data("45.5017", "-73.5673");
-    simdjson::ondemand::parser parser;
-    simdjson::ondemand::document doc = parser.iterate(simdjson::pad(weather_data_str));
+// Every cURL handle lives in here, so that they are all gone by the time
+// main() calls curl_global_cleanup().
+void run(int argc, char **argv) {
+    // The document refers to the client buffers, which must outlive it.
+    weather_client client;
+    simdjson::ondemand::document doc = client.iterate("45.5017", "-73.5673");
 
     // If it is simple enough, static reflection works fine.
     weather_data wd = doc["hourly"].get<weather_data>();
@@ -100,9 +49,24 @@ int main() {
             wd.windspeed_10m[i]);
     }
 
+    // Serializing it back: the float columns come out with the decimals
+    // annotated in weather_data, as the API wrote them.
+    std::string hourly = simdjson::to_json_formatted(wd);
+    fmt::print("Hourly JSON: {} bytes, starting with {:.80}\n", hourly.size(), hourly);
+
+    if (argc > 1) {
+        // The document still refers to the first buffer: upload with
+        // another client.
+        weather_client uploader;
+        simdjson::padded_string_view reply = uploader.post_json(argv[1], wd);
+        fmt::print("Uploaded the forecast to {}, {} bytes in reply\n", argv[1], reply.size());
+    }
+
     // It won't work with MyDate, so we need  to have a custom deserializer.
     // complicated weather data
-    complicated_weather_data cwd = doc["hourly"].get<complicated_weather_data>();
+    // Rather than parsing "hourly" a second time, we derive it from wd: the
+    // float columns are moved, only the time column goes through MyDate.
+    complicated_weather_data cwd = simdjson::project<complicated_weather_data>(std::move(wd));
     for (size_t i = 0; i < cwd.time.size(); ++i) {
         fmt::print("CWD Time: {}, Temperature: {:.1f}°C, Humidity: {:.1f}%, Wind Direction: {:.1f}°, Precipitation: {:.1f}mm, Wind Speed: {:.1f}km/h\n",
             cwd.time[i].to_string(),
@@ -112,5 +76,38 @@ int main() {
             cwd.precipitation[i],
             cwd.windspeed_10m[i]);
     }
+
+    // Zero-copy mode: the handle takes over the response buffer and owns the
+    // parser, the time column views the input instead of copying it.
+    simdjson::document_handle<weather_data_view> forecast(client.release_response(), "/hourly");
+    for (size_t i = 0; i < forecast->time.size(); ++i) {
+        fmt::print("View Time: {}, Temperature: {:.1f}°C\n",
+            forecast->time[i].to_string(),
+            forecast->temperature_2m[i]);
+    }
+
+    // Many forecasts at once, on this thread: every request is in flight
+    // before the first answer comes back.
+    {
+        weather_loop loop;
+        city_forecast(loop, "Montreal", "45.5017", "-73.5673");
+        city_forecast(loop, "Aurora", "39.7294", "-104.8319");
+        city_forecast(loop, "Paris", "48.8566", "2.3522");
+        city_forecast(loop, "Tokyo", "35.6762", "139.6503");
+        loop.run();
+    }
+
+    // Built with -DSIMDJSON_INSTRUMENTATION=ON: what all of the above did.
+    if (instrumentation::enabled) {
+        fmt::print("{}", instrumentation::prometheus_text());
+    }
+}
+
+// Usage: ./webservice [upload_url]
+// With upload_url, the hourly forecast is also POSTed there, streamed.
+int main(int argc, char **argv) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    run(argc, argv);
+    curl_global_cleanup();
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+// Multi-threaded driver for the webservice demo: each thread fetches and
+// parses forecasts through a shared client_pool, we report requests/s and
+// the p50/p99 latency for 1..N threads.
+//
+// Usage: ./webservice_bench [max_threads] [requests_per_thread] [base_url]
+// Point base_url at a local mirror of the forecast endpoint before running
+// thousands of requests against it.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <simdjson.h>
+
+#include "weather_client.h"
+#include "weather_data.h"
+
+double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) { return 0; }
+    size_t index = size_t(p * double(sorted.size() - 1));
+    return sorted[index];
+}
+
+int main(int argc, char **argv) {
+    size_t max_threads = argc > 1 ? std::stoul(argv[1]) : std::thread::hardware_concurrency();
+    size_t requests_per_thread = argc > 2 ? std::stoul(argv[2]) : 100;
+    std::string base_url = argc > 3 ? argv[3] : std::string(open_meteo_url);
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    fmt::print("{:>8} {:>12} {:>12} {:>12}\n", "threads", "requests/s", "p50 (ms)", "p99 (ms)");
+    for (size_t thread_count = 1; thread_count <= max_threads; thread_count++) {
+        client_pool pool(thread_count, base_url);
+        // Warm up: one request per client opens the connection and sizes the
+        // buffers and the parser, the timed loop then reuses them.
+        {
+            std::vector<client_pool::lease> leases;
+            for (size_t i = 0; i < thread_count; i++) { leases.push_back(pool.acquire()); }
+            for (auto &client : leases) {
+                simdjson::ondemand::document doc = client->iterate("45.5017", "-73.5673");
+                weather_data wd = doc["hourly"].get<weather_data>();
+            }
+        }
+        std::vector<std::vector<double>> latencies(thread_count);
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < thread_count; t++) {
+            threads.emplace_back([&, t] {
+                std::vector<double> &mine = latencies[t];
+                mine.reserve(requests_per_thread);
+                std::string latitude, longitude;
+                for (size_t i = 0; i < requests_per_thread; i++) {
+                    // Fan out over a grid of lat/long lookups.
+                    latitude.clear();
+                    longitude.clear();
+                    fmt::format_to(std::back_inserter(latitude), "{:.4f}", -60.0 + double((t * requests_per_thread + i) % 120));
+                    fmt::format_to(std::back_inserter(longitude), "{:.4f}", -180.0 + double(i % 360));
+                    auto request_start = std::chrono::steady_clock::now();
+                    auto client = pool.acquire();
+                    simdjson::ondemand::document doc = client->iterate(latitude, longitude);
+                    weather_data wd = doc["hourly"].get<weather_data>();
+                    auto request_end = std::chrono::steady_clock::now();
+                    mine.push_back(std::chrono::duration<double, std::milli>(request_end - request_start).count());
+                }
+            });
+        }
+        for (auto &thread : threads) { thread.join(); }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::vector<double> all;
+        for (auto &mine : latencies) { all.insert(all.end(), mine.begin(), mine.end()); }
+        std::sort(all.begin(), all.end());
+        fmt::print("{:>8} {:>12.1f} {:>12.2f} {:>12.2f}\n", thread_count,
+            double(all.size()) / elapsed, percentile(all, 0.50), percentile(all, 0.99));
+    }
+    curl_global_cleanup();
+    return EXIT_SUCCESS;
+}